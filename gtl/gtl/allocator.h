@@ -19,6 +19,7 @@
 
 #include "allocator/allocator.h"
 #include "allocator/stl_allocator.h"
+#include "allocator/arena_allocator.h"
 
 #endif
 
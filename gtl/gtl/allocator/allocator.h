@@ -19,18 +19,82 @@
 
 #include <gtl/common.h>
 #include <gtl/noncopyable.h>
-#include <gtl/allocator.h>
 #include <gtl/scoped.h>
+#include <type_traits>
 
 namespace gtl {
 
+	namespace details {
+
+//Strictest fundamental alignment
+union Max_Align
+{
+	long double ld;
+	long long ll;
+	double d;
+	void* p;
+	void (*f)();
+};
+
+	} //details
+
 //stateful allocator interface
 class Allocator
 {
 public:
+	//Alignment of every block returned by allocate
+	static size_t const default_alignment = std::alignment_of<details::Max_Align>::value;
+
 	virtual void* allocate(size_t count) = 0;
 	virtual void deallocate(void* p) = 0;
 
+	//Blocks with an alignment stricter than the default must be released
+	//through the sized deallocate with the same alignment.  The default
+	//over-allocates and keeps the original pointer in front of the block.
+	virtual void* allocate(size_t count, size_t align)
+	{
+		if(align <= default_alignment)
+		{
+			return allocate(count);
+		}
+
+		char* mem = static_cast<char*>(allocate(count + align - 1 + sizeof(void*)));
+		if(!mem)
+		{
+			return 0;
+		}
+
+		char* p = reinterpret_cast<char*>(
+			(reinterpret_cast<uintptr_t>(mem + sizeof(void*)) + align - 1) & ~(uintptr_t(align) - 1));
+		reinterpret_cast<void**>(p)[-1] = mem;
+		return p;
+	}
+
+	//size and align must be the ones the block was allocated with, which
+	//spares implementations from looking the size up
+	virtual void deallocate(void* p, size_t size, size_t align)
+	{
+		GTL_REF(size);
+
+		if(align <= default_alignment)
+		{
+			deallocate(p);
+		}
+		else if(p)
+		{
+			deallocate(reinterpret_cast<void**>(p)[-1]);
+		}
+	}
+
+	//Grows or shrinks the block in place, returns false if it can't be done
+	virtual bool try_expand(void* p, size_t old_size, size_t new_size)
+	{
+		GTL_REF(p);
+		GTL_REF(old_size);
+		GTL_REF(new_size);
+		return false;
+	}
+
 protected:
 	virtual ~Allocator() {}
 };
@@ -0,0 +1,222 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_ALLOCATOR_ARENA_ALLOCATOR_H
+#define GTL_ALLOCATOR_ARENA_ALLOCATOR_H
+
+#include <gtl/common.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <algorithm>
+#include "allocator.h"
+
+namespace gtl {
+
+//Bump allocator over a chain of blocks taken from an upstream allocator.
+//deallocate does nothing, memory is reclaimed in bulk by rewinding to a
+//mark, reset or release.
+class Arena_Allocator : public Allocator, private Noncopyable
+{
+	struct Block
+	{
+		Block* prev;
+		char* end;
+	};
+
+public:
+	struct Mark
+	{
+		Block* block;
+		char* cursor;
+	};
+
+	Arena_Allocator(Allocator* upstream, size_t block_size = 64 * 1024) :
+		m_upstream(upstream),
+		m_block_size(block_size),
+		m_block(0),
+		m_spare(0),
+		m_cursor(0),
+		m_end(0)
+	{
+	}
+
+	~Arena_Allocator()
+	{
+		release();
+	}
+
+	virtual void* allocate(size_t count) override
+	{
+		return allocate(count, default_alignment);
+	}
+
+	virtual void* allocate(size_t count, size_t alignment) override
+	{
+		char* p = align(m_cursor, alignment);
+		if(!m_block || p > m_end || count > static_cast<size_t>(m_end - p))
+		{
+			//Reserve enough for the worst case alignment padding
+			add_block(count + (alignment > default_alignment ? alignment : 0));
+			p = align(m_cursor, alignment);
+		}
+
+		m_cursor = p + count;
+		return p;
+	}
+
+	virtual void deallocate(void* /*p*/) override
+	{
+	}
+
+	virtual void deallocate(void* /*p*/, size_t /*size*/, size_t /*align*/) override
+	{
+	}
+
+	//The most recent allocation can be resized in place
+	virtual bool try_expand(void* p, size_t old_size, size_t new_size) override
+	{
+		char* ptr = static_cast<char*>(p);
+		if(ptr + old_size != m_cursor || new_size > static_cast<size_t>(m_end - ptr))
+		{
+			return false;
+		}
+
+		m_cursor = ptr + new_size;
+		return true;
+	}
+
+	Mark mark() const
+	{
+		Mark mark = {m_block, m_cursor};
+		return mark;
+	}
+
+	//Frees everything allocated since mark was taken.  Blocks are kept for
+	//reuse, except for oversized ones.
+	void rewind(Mark const& mark)
+	{
+		while(m_block != mark.block)
+		{
+			GTL_ASSERT(m_block);
+			Block* block = m_block;
+			m_block = block->prev;
+			retire(block);
+		}
+
+		m_cursor = mark.cursor;
+		m_end = m_block ? m_block->end : 0;
+	}
+
+	//Frees every allocation, keeping the blocks for reuse
+	void reset()
+	{
+		Mark empty = {0, 0};
+		rewind(empty);
+	}
+
+	//Frees every allocation and returns all blocks to the upstream allocator
+	void release()
+	{
+		reset();
+
+		while(m_spare)
+		{
+			Block* block = m_spare;
+			m_spare = block->prev;
+			m_upstream->deallocate(block);
+		}
+	}
+
+private:
+	static size_t header_size()
+	{
+		return (sizeof(Block) + default_alignment - 1) & ~(default_alignment - 1);
+	}
+
+	static char* align(char* p, size_t alignment)
+	{
+		return reinterpret_cast<char*>(
+			(reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+	}
+
+	void add_block(size_t count)
+	{
+		Block* block = 0;
+		if(m_spare && count <= m_block_size)
+		{
+			block = m_spare;
+			m_spare = block->prev;
+		}
+		else
+		{
+			size_t size = header_size() + std::max(count, m_block_size);
+			char* mem = static_cast<char*>(m_upstream->allocate(size));
+			block = reinterpret_cast<Block*>(mem);
+			block->end = mem + size;
+		}
+
+		block->prev = m_block;
+		m_block = block;
+		m_cursor = reinterpret_cast<char*>(block) + header_size();
+		m_end = block->end;
+	}
+
+	void retire(Block* block)
+	{
+		size_t size = block->end - reinterpret_cast<char*>(block);
+		if(size == header_size() + m_block_size)
+		{
+			block->prev = m_spare;
+			m_spare = block;
+		}
+		else
+		{
+			m_upstream->deallocate(block);
+		}
+	}
+
+private:
+	Allocator* m_upstream;
+	size_t m_block_size;
+	Block* m_block;
+	Block* m_spare;
+	char* m_cursor;
+	char* m_end;
+};
+
+//Rewinds the arena on scope exit
+class Arena_Scope : private Noncopyable
+{
+public:
+	Arena_Scope(Arena_Allocator& arena) :
+		m_arena(arena),
+		m_mark(arena.mark())
+	{
+	}
+
+	~Arena_Scope()
+	{
+		m_arena.rewind(m_mark);
+	}
+
+private:
+	Arena_Allocator& m_arena;
+	Arena_Allocator::Mark m_mark;
+};
+
+} //gtl
+
+#endif
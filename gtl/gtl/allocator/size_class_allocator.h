@@ -0,0 +1,332 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_ALLOCATOR_SIZE_CLASS_ALLOCATOR_H
+#define GTL_ALLOCATOR_SIZE_CLASS_ALLOCATOR_H
+
+#include <gtl/common.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/context.h>
+#include <gtl/pool/pool.h>
+#include <gtl/containers/vector.h>
+#include <algorithm>
+#include "allocator.h"
+
+namespace gtl {
+
+//General purpose allocator that serves small blocks from one growable Pool
+//per size class, and forwards anything larger than max_size upstream.
+//
+//Pool slabs are carved from region_size aligned regions, each starting with
+//the index of the class it serves.  A pointer is mapped back to its class by
+//checking the (sorted) chunk table and masking down to the region header,
+//so deallocate needs no per-block size header.
+class Size_Class_Allocator : public Allocator, private Noncopyable
+{
+public:
+	static size_t const region_size = 64 * 1024;
+	static size_t const max_size = 2048;
+	static size_t const class_count = 24;
+
+	Size_Class_Allocator(Allocator* upstream, size_t chunk_regions = 16) :
+		m_upstream(upstream),
+		m_upstream_context(upstream),
+		m_chunk_regions(std::max(chunk_regions, size_t(1))),
+		m_chunks(&m_upstream_context),
+		m_free_regions(0)
+	{
+		for(size_t i = 0; i < class_count; ++i)
+		{
+			new (size_class(i)) Size_Class(this, i);
+		}
+	}
+
+	~Size_Class_Allocator()
+	{
+		//Pools hand their regions back first, then the chunks can go
+		for(size_t i = 0; i < class_count; ++i)
+		{
+			destruct(size_class(i));
+		}
+
+		for(Vector<Chunk>::range all = m_chunks.all(); !all.empty(); all.pop())
+		{
+			m_upstream->deallocate(all.get().mem);
+		}
+	}
+
+	virtual void* allocate(size_t count) override
+	{
+		if(count > max_size)
+		{
+			return m_upstream->allocate(count);
+		}
+
+		return size_class(class_of(count))->pool.allocate();
+	}
+
+	virtual void* allocate(size_t count, size_t align) override
+	{
+		if(align > default_alignment)
+		{
+			return m_upstream->allocate(count, align);
+		}
+
+		return allocate(count);
+	}
+
+	//The size picks the class directly, no region lookup
+	virtual void deallocate(void* p, size_t size, size_t align) override
+	{
+		if(align > default_alignment || size > max_size)
+		{
+			m_upstream->deallocate(p, size, align);
+		}
+		else if(p)
+		{
+			GTL_ASSERT(owns(static_cast<char*>(p)));
+			GTL_ASSERT(region_of(static_cast<char*>(p))->size_class == class_of(size));
+			size_class(class_of(size))->pool.deallocate(p);
+		}
+	}
+
+	virtual void deallocate(void* p) override
+	{
+		if(!p)
+		{
+			return;
+		}
+
+		char* ptr = static_cast<char*>(p);
+		if(owns(ptr))
+		{
+			Region_Header* header = region_of(ptr);
+			size_class(header->size_class)->pool.deallocate(p);
+		}
+		else
+		{
+			m_upstream->deallocate(p);
+		}
+	}
+
+	//Small blocks can grow or shrink within their class
+	virtual bool try_expand(void* p, size_t old_size, size_t new_size) override
+	{
+		return old_size <= max_size && new_size <= max_size &&
+			class_of(old_size) == class_of(new_size) &&
+			owns(static_cast<char*>(p));
+	}
+
+	static size_t class_of(size_t count)
+	{
+		GTL_ASSERT(count <= max_size);
+
+		//16 byte steps up to 128, then 4 classes per power of two
+		if(count <= 128)
+		{
+			return (std::max(count, size_t(1)) + 15) / 16 - 1;
+		}
+
+		size_t base = 128;
+		size_t step = 32;
+		size_t index = 8;
+		while(count > base * 2)
+		{
+			base *= 2;
+			step *= 2;
+			index += 4;
+		}
+
+		return index + (count - base + step - 1) / step - 1;
+	}
+
+	static size_t class_size(size_t index)
+	{
+		GTL_ASSERT(index < class_count);
+
+		if(index < 8)
+		{
+			return (index + 1) * 16;
+		}
+
+		size_t group = (index - 8) / 4;
+		return (128 << group) + ((index - 8) % 4 + 1) * (32 << group);
+	}
+
+private:
+	struct Region_Header
+	{
+		size_t size_class;
+	};
+
+	struct Chunk
+	{
+		char* begin;
+		char* end;
+		void* mem;
+	};
+
+	//Feeds one class pool with whole regions
+	class Region_Source : public Allocator
+	{
+	public:
+		Region_Source(Size_Class_Allocator* owner, size_t size_class) :
+			m_owner(owner), m_size_class(size_class) {}
+
+		virtual void* allocate(size_t count) override
+		{
+			GTL_ASSERT(count <= region_payload());
+			GTL_REF(count);
+			return m_owner->acquire_region(m_size_class);
+		}
+
+		virtual void deallocate(void* p) override
+		{
+			m_owner->release_region(static_cast<char*>(p));
+		}
+
+	private:
+		Size_Class_Allocator* m_owner;
+		size_t m_size_class;
+	};
+
+	struct Size_Class
+	{
+		Size_Class(Size_Class_Allocator* owner, size_t index) :
+			source(owner, index),
+			context(&source),
+			pool(&context, class_size(index), default_alignment, policy(index))
+		{
+		}
+
+		static Pool_Policy policy(size_t index)
+		{
+			size_t links = Pool::slab_capacity(class_size(index), default_alignment, region_payload());
+
+			//Lazily acquire one region at a time, keep two spare
+			return Pool_Policy(0).grow(1.0f, links).release_above(links * 2);
+		}
+
+		Region_Source source;
+		Context context;
+		Pool pool;
+	};
+
+	static size_t region_header_size()
+	{
+		return (sizeof(Region_Header) + default_alignment - 1) & ~(default_alignment - 1);
+	}
+
+	static size_t region_payload()
+	{
+		return region_size - region_header_size();
+	}
+
+	static Region_Header* region_of(char* p)
+	{
+		return reinterpret_cast<Region_Header*>(
+			reinterpret_cast<uintptr_t>(p) & ~(uintptr_t(region_size) - 1));
+	}
+
+	static char*& next_region(char* region)
+	{
+		return *reinterpret_cast<char**>(region);
+	}
+
+	Size_Class* size_class(size_t index)
+	{
+		return reinterpret_cast<Size_Class*>(&m_classes[index]);
+	}
+
+	struct Chunk_Less
+	{
+		bool operator()(char const* p, Chunk const& chunk) const
+		{
+			return p < chunk.begin;
+		}
+	};
+
+	bool owns(char const* p) const
+	{
+		Chunk const* end = m_chunks.end();
+		Chunk const* chunk = std::upper_bound(m_chunks.begin(), end, p, Chunk_Less());
+		if(chunk == m_chunks.begin())
+		{
+			return false;
+		}
+
+		--chunk;
+		return p < chunk->end;
+	}
+
+	void* acquire_region(size_t size_class)
+	{
+		if(!m_free_regions)
+		{
+			add_chunk();
+		}
+
+		char* region = m_free_regions;
+		m_free_regions = next_region(region);
+
+		reinterpret_cast<Region_Header*>(region)->size_class = size_class;
+		return region + region_header_size();
+	}
+
+	void release_region(char* p)
+	{
+		char* region = reinterpret_cast<char*>(region_of(p));
+		next_region(region) = m_free_regions;
+		m_free_regions = region;
+	}
+
+	void add_chunk()
+	{
+		//One extra region worth of slack to align the chunk
+		size_t size = (m_chunk_regions + 1) * region_size;
+		char* mem = static_cast<char*>(m_upstream->allocate(size));
+
+		Chunk chunk;
+		chunk.mem = mem;
+		chunk.begin = reinterpret_cast<char*>(region_of(mem + region_size - 1));
+		chunk.end = chunk.begin +
+			((mem + size - chunk.begin) / region_size) * region_size;
+
+		Chunk* position = std::upper_bound(m_chunks.begin(), m_chunks.end(), chunk.begin, Chunk_Less());
+		m_chunks.insert(position, chunk);
+
+		for(char* region = chunk.end; region > chunk.begin; )
+		{
+			region -= region_size;
+			next_region(region) = m_free_regions;
+			m_free_regions = region;
+		}
+	}
+
+private:
+	Allocator* m_upstream;
+	Context m_upstream_context;
+	size_t m_chunk_regions;
+	Vector<Chunk> m_chunks;
+	char* m_free_regions;
+	std::aligned_storage<sizeof(Size_Class), std::alignment_of<Size_Class>::value>::type
+		m_classes[class_count];
+};
+
+} //gtl
+
+#endif
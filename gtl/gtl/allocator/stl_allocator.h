@@ -95,12 +95,12 @@ public:
 	pointer allocate(size_type count,
 		STL_Allocator<void>::const_pointer = 0)
 	{
-		return static_cast<pointer>(m_alloc->allocate(sizeof(T) * count));
+		return static_cast<pointer>(m_alloc->allocate(sizeof(T) * count, std::alignment_of<T>::value));
 	}
 
-	void deallocate(pointer p, size_type)
+	void deallocate(pointer p, size_type count)
 	{
-		m_alloc->deallocate(p);
+		m_alloc->deallocate(p, sizeof(T) * count, std::alignment_of<T>::value);
 	}
 
 	size_type max_size() const throw()
@@ -43,6 +43,20 @@
 #   define GTL_UNWIND(action) 
 # endif
 
+//Stricter alignment for a type or member, no alignas before vs14
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#	define GTL_ALIGNAS(n) __declspec(align(n))
+#else
+#	define GTL_ALIGNAS(n) alignas(n)
+#endif
+
+//16 byte compare and swap, on x64 gcc and clang only with -mcx16
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) || (defined(_MSC_VER) && defined(_M_X64))
+#	define GTL_WIDE_CAS 1
+#else
+#	define GTL_WIDE_CAS 0
+#endif
+
 //Unchecked functions not available after vs10, thanks MS
 #if defined(_MSC_VER) && _MSC_VER < 1600
 #	define GTL_USE_UNCHECKED_STD
@@ -0,0 +1,278 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_ATOMIC_SLIST_H
+#define GTL_CONTAINERS_ATOMIC_SLIST_H
+
+#include <gtl/common.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/diagnostics/exception.h>
+#include <atomic>
+#include "slist.h"
+
+#if GTL_WIDE_CAS && defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace gtl {
+
+namespace details {
+
+//The top of an Atomic_Slist, a node address and a tag swapped as one
+struct Slist_Head
+{
+	uintptr_t node;
+	uintptr_t tag;
+};
+
+#if GTL_WIDE_CAS
+//Address and tag side by side, each a full word
+class Atomic_Slist_Head
+{
+public:
+	static uintptr_t const max_tag = ~uintptr_t(0);
+
+	Atomic_Slist_Head()
+	{
+		m_word[0] = m_word[1] = 0;
+	}
+
+	Slist_Head load() const
+	{
+		//A swap of the empty head for itself reads both halves at once
+		Slist_Head head = {0, 0};
+		compare_exchange(head, head);
+		return head;
+	}
+
+	//Full barrier.  On failure expected is updated to the current head.
+	bool compare_exchange(Slist_Head& expected, Slist_Head desired) const
+	{
+#	ifdef _MSC_VER
+		__int64 comparand[2] = {__int64(expected.node), __int64(expected.tag)};
+		bool done = _InterlockedCompareExchange128(m_word, __int64(desired.tag), __int64(desired.node), comparand) != 0;
+		expected.node = uintptr_t(comparand[0]);
+		expected.tag = uintptr_t(comparand[1]);
+		return done;
+#	else
+		typedef unsigned __int128 wide_t;
+		wide_t old = wide_t(expected.node) | (wide_t(expected.tag) << 64);
+		wide_t now = __sync_val_compare_and_swap(reinterpret_cast<wide_t*>(m_word), old,
+			wide_t(desired.node) | (wide_t(desired.tag) << 64));
+		expected.node = uintptr_t(now);
+		expected.tag = uintptr_t(now >> 64);
+		return now == old;
+#	endif
+	}
+
+	//Any node address fits
+	static bool fits(void const*) {return true;}
+
+private:
+	//Mutable as even a load swaps
+#	ifdef _MSC_VER
+	GTL_ALIGNAS(16) mutable __int64 volatile m_word[2];
+#	else
+	GTL_ALIGNAS(16) mutable uintptr_t m_word[2];
+#	endif
+};
+#else
+//Address and tag packed in one 64 bit word, the address takes the low 48
+//bits on 64 bit targets and the low 32 on 32 bit ones
+class Atomic_Slist_Head
+{
+	typedef unsigned long long word_t;
+	static unsigned const pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+
+public:
+	static uintptr_t const max_tag = uintptr_t((word_t(1) << (64 - pointer_bits)) - 1);
+
+	Atomic_Slist_Head() : m_word(0)
+	{
+		static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Atomic_Slist needs a lock-free 64 bit compare and swap");
+		static_assert(sizeof(void*) <= 8, "pointers must leave room for the tag");
+	}
+
+	Slist_Head load() const
+	{
+		return unpack(m_word.load(std::memory_order_acquire));
+	}
+
+	bool compare_exchange(Slist_Head& expected, Slist_Head desired)
+	{
+		word_t word = pack(expected);
+		bool done = m_word.compare_exchange_strong(word, pack(desired));
+		expected = unpack(word);
+		return done;
+	}
+
+	//False for addresses the word has no room for, e.g. with 5 level paging
+	static bool fits(void const* p)
+	{
+		return (word_t(reinterpret_cast<uintptr_t>(p)) >> pointer_bits) == 0;
+	}
+
+private:
+	static word_t pack(Slist_Head head)
+	{
+		return (word_t(head.tag & max_tag) << pointer_bits) | word_t(head.node);
+	}
+
+	static Slist_Head unpack(word_t word)
+	{
+		Slist_Head head = {uintptr_t(word & ((word_t(1) << pointer_bits) - 1)), uintptr_t(word >> pointer_bits)};
+		return head;
+	}
+
+	std::atomic<word_t> m_word;
+};
+#endif
+
+}
+
+//Lock-free (Treiber) stack over the Slist hook, safe to push and pop from
+//any thread.  The head carries a tag bumped on every pop, so a node popped
+//and pushed back between another thread's read and its compare and swap
+//can't be mistaken for an unchanged head.
+//
+//With GTL_WIDE_CAS the tag is a full word next to the address.  Otherwise
+//both share a 64 bit word: 64 bit targets keep 16 bits of tag, so a thread
+//stalled across exactly a multiple of 65536 pops can still hit ABA, and
+//pushing a node above the low 48 bits of address space is an error.
+//
+//A pop may read the hook of a node another thread has just popped (the
+//tag then fails its compare and swap), so nodes must stay readable while
+//the stack is in use, e.g. by coming from a pool that outlives it.
+template <class T, class Tag = void> class Atomic_Slist : private Noncopyable
+{
+public:
+	typedef Slist_Node_T<Tag> node_t;
+	typedef Slist<T, Tag> list_type;
+
+	//Pops between two identical tags
+	static uintptr_t const max_tag = details::Atomic_Slist_Head::max_tag;
+
+	void push(T& x)
+	{
+		node_t* node = &x;
+		verify_fits(node);
+		link(node, node);
+	}
+
+	//Pushes all of list with a single publish, its front ends up on top
+	void push_all(list_type& list)
+	{
+		if(!list.empty())
+		{
+#if !GTL_WIDE_CAS
+			for(typename list_type::range all = list.all(); !all.empty(); all.pop())
+			{
+				verify_fits(&all.get());
+			}
+#endif
+			link(&list.front(), &list.back());
+			list.clear();
+		}
+	}
+
+	//Returns 0 when empty
+	T* pop()
+	{
+		details::Slist_Head head = m_head.load();
+		details::Slist_Head next;
+		do
+		{
+			if(!head.node)
+			{
+				return 0;
+			}
+
+			next.node = reinterpret_cast<uintptr_t>(node_of(head)->next.load(std::memory_order_relaxed));
+			next.tag = head.tag + 1;
+		}
+		while(!m_head.compare_exchange(head, next));
+
+		return static_cast<T*>(node_of(head));
+	}
+
+	//Takes everything at once, appended to list from the top down.
+	//Returns how many were taken.
+	size_t pop_all(list_type& list)
+	{
+		details::Slist_Head head = m_head.load();
+		details::Slist_Head empty;
+		do
+		{
+			empty.node = 0;
+			empty.tag = head.tag + 1;
+		}
+		while(!m_head.compare_exchange(head, empty));
+
+		size_t count = 0;
+		for(node_t* node = node_of(head); node; ++count)
+		{
+			node_t* next = node->get_next();
+			list.push_back(*static_cast<T*>(node));
+			node = next;
+		}
+
+		return count;
+	}
+
+	//May be stale by the time it returns
+	bool empty() const
+	{
+		return m_head.load().node == 0;
+	}
+
+private:
+	static node_t* node_of(details::Slist_Head head)
+	{
+		return reinterpret_cast<node_t*>(head.node);
+	}
+
+	//Checked in release builds too, a cut off address would corrupt the stack
+	static void verify_fits(node_t const* node)
+	{
+		if(!details::Atomic_Slist_Head::fits(node))
+		{
+			raise_exception(Exception("node address too wide for the Atomic_Slist head"));
+		}
+	}
+
+	//Publishes the chain first..last on top
+	void link(node_t* first, node_t* last)
+	{
+		details::Slist_Head head = m_head.load();
+		details::Slist_Head top;
+		do
+		{
+			last->next.store(node_of(head), std::memory_order_relaxed);
+			top.node = reinterpret_cast<uintptr_t>(first);
+			top.tag = head.tag;
+		}
+		while(!m_head.compare_exchange(head, top));
+	}
+
+private:
+	details::Atomic_Slist_Head m_head;
+};
+
+} //namespace
+
+#endif
@@ -22,6 +22,8 @@
 #include <gtl/type_traits.h>
 #include <gtl/range.h>
 #include <iterator>
+#include <cstring>
+#include <utility>
 
 namespace gtl {
 
@@ -74,6 +76,50 @@ void destruct_range(Range_T range)
 	}
 }
 
+//Moves [first, last) to raw memory at dest bitwise, the source is left
+//uninitialized.  Only for is_trivially_relocatable types.
+template <class T>
+inline T* uninitialized_relocate(T* first, T* last, T* dest)
+{
+	if(first != last)
+	{
+		std::memcpy(dest, first, sizeof(T) * (last - first));
+	}
+	return dest + (last - first);
+}
+
+#if GTL_EXCEPTION
+//Move constructs [first, last) into raw memory at dest, copying instead when
+//the move may throw so the source stays intact on failure
+template <class T>
+T* uninitialized_move_if_noexcept(T* first, T* last, T* dest)
+{
+	T* cur = dest;
+	try
+	{
+		for(; first != last; ++first, ++cur)
+		{
+			new (cur) T(std::move_if_noexcept(*first));
+		}
+	}
+	GTL_UNWIND(destruct_range(Iterator_Range<T*>(dest, cur)))
+
+	return cur;
+}
+#else
+//Nothing can throw, so always move.  GTL_NOTHROW is empty here and
+//move_if_noexcept would deep copy anything copyable.
+template <class T>
+T* uninitialized_move_if_noexcept(T* first, T* last, T* dest)
+{
+	for(; first != last; ++first, ++dest)
+	{
+		new (dest) T(std::move(*first));
+	}
+	return dest;
+}
+#endif
+
 template <class Range_T>
 void construct_range_aux(Range_T range, true_type /*no_throw*/)
 {
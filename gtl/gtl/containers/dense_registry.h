@@ -0,0 +1,432 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_DENSE_REGISTRY_H
+#define GTL_CONTAINERS_DENSE_REGISTRY_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/containers/vector.h>
+#include <gtl/range.h>
+#include <algorithm>
+#include "registry.h"
+
+namespace gtl { namespace registry {
+
+//Registry tree kept in one node array, addressed by 32-bit ids instead of
+//pointers.  Children are found through per node tables living in two
+//shared arrays: a dense table indexed by the child index directly, or a
+//sorted (index, id) table once the indices get too scattered for that.
+//
+//Ids stay valid until clear().  Node data moves when the array grows, so
+//references from data() only last until the next get.  Outgrown tables are
+//left behind in the shared arrays, which geometric growth bounds to about
+//the size of the live ones.
+template <class T, class Index = unsigned int> class Dense_Registry : private Noncopyable
+{
+public:
+	typedef Index index_t;
+
+	static node_id const root = 0;
+	static node_id const missing = node_id(-1);
+
+	struct Child
+	{
+		index_t index;
+		node_id node;
+	};
+
+	class Child_Range;
+
+	Dense_Registry(Context const* context) :
+		m_nodes(context),
+		m_dense(context),
+		m_sparse(context)
+	{
+		m_nodes.push_back(Dense_Node());
+	}
+
+	//Drops everything but a fresh root
+	void clear()
+	{
+		m_nodes.clear();
+		m_dense.clear();
+		m_sparse.clear();
+		m_nodes.push_back(Dense_Node());
+	}
+
+	void reserve(size_t nodes)
+	{
+		m_nodes.reserve(nodes);
+	}
+
+	size_t size() const {return m_nodes.size();}
+
+	T& data(node_id node) {return m_nodes[node].data;}
+	T const& data(node_id node) const {return m_nodes[node].data;}
+
+	size_t child_count(node_id node) const {return m_nodes[node].count;}
+
+	node_id try_get(node_id parent, index_t index) const
+	{
+		Dense_Node const& node = m_nodes[parent];
+		if(node.kind == dense_table)
+		{
+			return index < node.length ? m_dense[node.table + index] : missing;
+		}
+		else if(node.kind == sparse_table)
+		{
+			Sparse_Entry const* first = m_sparse.begin() + node.table;
+			Sparse_Entry const* last = first + node.count;
+			Sparse_Entry const* found = std::lower_bound(first, last, index, Sparse_Less());
+			return found != last && found->index == index ? found->node : missing;
+		}
+
+		return missing;
+	}
+
+	node_id get(node_id parent, index_t index)
+	{
+		node_id child = try_get(parent, index);
+		if(child == missing)
+		{
+			child = node_id(m_nodes.size());
+			m_nodes.push_back(Dense_Node());
+			link(parent, index, child);
+		}
+
+		return child;
+	}
+
+	template <class Range_T> node_id get_path(Range_T path, node_id from = root)
+	{
+		node_id current = from;
+
+		for(; !path.empty(); path.pop())
+		{
+			current = get(current, path.get());
+		}
+
+		return current;
+	}
+
+	template <class Range_T> node_id try_get_path(Range_T path, node_id from = root) const
+	{
+		node_id current = from;
+
+		for(; current != missing && !path.empty(); path.pop())
+		{
+			current = try_get(current, path.get());
+		}
+
+		return current;
+	}
+
+	//Yields a Child for each existing child, by increasing index
+	Child_Range children(node_id node) const;
+
+private:
+	enum Table_Kind
+	{
+		no_table,
+		dense_table,
+		sparse_table
+	};
+
+	//Dense tables up to this length are always fine, past it they must be
+	//at least a quarter full
+	static size_t const dense_minimum = 16;
+
+	struct Dense_Node
+	{
+		Dense_Node() : table(0), length(0), count(0), kind(no_table), data() {}
+
+		uint32_t table;
+		//Slots in a dense table, room for entries in a sparse one
+		uint32_t length;
+		uint32_t count;
+		uint32_t kind;
+		T data;
+	};
+
+	struct Sparse_Entry
+	{
+		index_t index;
+		node_id node;
+	};
+
+	struct Sparse_Less
+	{
+		bool operator()(Sparse_Entry const& entry, index_t index) const
+		{
+			return entry.index < index;
+		}
+	};
+
+	static bool dense_enough(size_t length, size_t count)
+	{
+		return length <= dense_minimum || length <= count * 4;
+	}
+
+	void link(node_id parent, index_t index, node_id child);
+
+	void grow_dense(Dense_Node& node, size_t length);
+	void grow_sparse(Dense_Node& node, size_t length);
+	void to_dense(Dense_Node& node, size_t length);
+	void to_sparse(Dense_Node& node, size_t length);
+
+private:
+	Vector<Dense_Node> m_nodes;
+	Vector<node_id> m_dense;
+	Vector<Sparse_Entry> m_sparse;
+};
+
+template <class T, class Index> node_id const Dense_Registry<T, Index>::root;
+template <class T, class Index> node_id const Dense_Registry<T, Index>::missing;
+template <class T, class Index> size_t const Dense_Registry<T, Index>::dense_minimum;
+
+template <class T, class Index>
+class Dense_Registry<T, Index>::Child_Range
+{
+public:
+	typedef Child get_type;
+
+	Child_Range(node_id const* dense, node_id const* dense_end,
+		Sparse_Entry const* sparse, Sparse_Entry const* sparse_end) :
+		m_dense(dense), m_dense_begin(dense), m_dense_end(dense_end),
+		m_sparse(sparse), m_sparse_end(sparse_end)
+	{
+		skip();
+	}
+
+	get_type get() const
+	{
+		Child child;
+		if(m_sparse != m_sparse_end)
+		{
+			child.index = m_sparse->index;
+			child.node = m_sparse->node;
+		}
+		else
+		{
+			child.index = index_t(m_dense - m_dense_begin);
+			child.node = *m_dense;
+		}
+		return child;
+	}
+
+	void pop()
+	{
+		if(m_sparse != m_sparse_end)
+		{
+			++m_sparse;
+		}
+		else
+		{
+			++m_dense;
+			skip();
+		}
+	}
+
+	bool empty() const {return m_sparse == m_sparse_end && m_dense == m_dense_end;}
+
+private:
+	void skip()
+	{
+		while(m_dense != m_dense_end && *m_dense == missing)
+		{
+			++m_dense;
+		}
+	}
+
+	node_id const* m_dense;
+	node_id const* m_dense_begin;
+	node_id const* m_dense_end;
+	Sparse_Entry const* m_sparse;
+	Sparse_Entry const* m_sparse_end;
+};
+
+template <class T, class Index>
+typename Dense_Registry<T, Index>::Child_Range Dense_Registry<T, Index>::children(node_id node) const
+{
+	Dense_Node const& parent = m_nodes[node];
+	if(parent.kind == dense_table)
+	{
+		node_id const* table = m_dense.begin() + parent.table;
+		return Child_Range(table, table + parent.length, 0, 0);
+	}
+	else if(parent.kind == sparse_table)
+	{
+		Sparse_Entry const* table = m_sparse.begin() + parent.table;
+		return Child_Range(0, 0, table, table + parent.count);
+	}
+
+	return Child_Range(0, 0, 0, 0);
+}
+
+template <class T, class Index>
+void Dense_Registry<T, Index>::link(node_id parent, index_t index, node_id child)
+{
+	Dense_Node& node = m_nodes[parent];
+
+	if(node.kind == no_table)
+	{
+		if(index < dense_minimum)
+		{
+			to_dense(node, std::max(size_t(index) + 1, size_t(4)));
+		}
+		else
+		{
+			to_sparse(node, 4);
+		}
+	}
+	else if(node.kind == dense_table && index >= node.length)
+	{
+		size_t length = std::max(size_t(index) + 1, size_t(node.length) * 2);
+		if(dense_enough(size_t(index) + 1, node.count + 1))
+		{
+			grow_dense(node, length);
+		}
+		else
+		{
+			to_sparse(node, std::max(size_t(node.count) * 2, size_t(4)));
+		}
+	}
+
+	if(node.kind == dense_table)
+	{
+		m_dense[node.table + index] = child;
+		++node.count;
+		return;
+	}
+
+	Sparse_Entry const* first = m_sparse.begin() + node.table;
+	Sparse_Entry const* last = first + node.count;
+	Sparse_Entry const* largest = node.count ? last - 1 : 0;
+
+	//Filled up enough to index directly again
+	if(largest && dense_enough(size_t(std::max(largest->index, index)) + 1, node.count + 1))
+	{
+		to_dense(node, size_t(std::max(largest->index, index)) + 1);
+		m_dense[node.table + index] = child;
+		++node.count;
+		return;
+	}
+
+	if(node.count == node.length)
+	{
+		grow_sparse(node, size_t(node.length) * 2);
+	}
+
+	Sparse_Entry* begin = m_sparse.begin() + node.table;
+	Sparse_Entry* end = begin + node.count;
+	Sparse_Entry* position = std::lower_bound(begin, end, index, Sparse_Less());
+	std::copy_backward(position, end, end + 1);
+	position->index = index;
+	position->node = child;
+	++node.count;
+}
+
+template <class T, class Index>
+void Dense_Registry<T, Index>::grow_dense(Dense_Node& node, size_t length)
+{
+	//The last table grows where it is
+	if(node.table + node.length == m_dense.size())
+	{
+		m_dense.resize(node.table + length, missing);
+	}
+	else
+	{
+		size_t table = m_dense.size();
+		m_dense.resize(table + length, missing);
+		std::copy(m_dense.begin() + node.table, m_dense.begin() + node.table + node.length, m_dense.begin() + table);
+		node.table = uint32_t(table);
+	}
+
+	node.length = uint32_t(length);
+}
+
+template <class T, class Index>
+void Dense_Registry<T, Index>::grow_sparse(Dense_Node& node, size_t length)
+{
+	if(node.table + node.length == m_sparse.size())
+	{
+		m_sparse.resize(node.table + length);
+	}
+	else
+	{
+		size_t table = m_sparse.size();
+		m_sparse.resize(table + length);
+		std::copy(m_sparse.begin() + node.table, m_sparse.begin() + node.table + node.count, m_sparse.begin() + table);
+		node.table = uint32_t(table);
+	}
+
+	node.length = uint32_t(length);
+}
+
+//Moves the children of a sparse (or childless) node into a new dense table
+template <class T, class Index>
+void Dense_Registry<T, Index>::to_dense(Dense_Node& node, size_t length)
+{
+	size_t table = m_dense.size();
+	m_dense.resize(table + length, missing);
+
+	if(node.kind == sparse_table)
+	{
+		Sparse_Entry const* first = m_sparse.begin() + node.table;
+		for(Sparse_Entry const* entry = first; entry != first + node.count; ++entry)
+		{
+			m_dense[table + entry->index] = entry->node;
+		}
+	}
+
+	node.table = uint32_t(table);
+	node.length = uint32_t(length);
+	node.kind = dense_table;
+}
+
+//Moves the children of a dense (or childless) node into a new sparse table
+template <class T, class Index>
+void Dense_Registry<T, Index>::to_sparse(Dense_Node& node, size_t length)
+{
+	size_t table = m_sparse.size();
+	m_sparse.resize(table + length);
+
+	if(node.kind == dense_table)
+	{
+		Sparse_Entry* out = m_sparse.begin() + table;
+		for(size_t i = 0; i < node.length; ++i)
+		{
+			node_id child = m_dense[node.table + i];
+			if(child != missing)
+			{
+				out->index = index_t(i);
+				out->node = child;
+				++out;
+			}
+		}
+	}
+
+	node.table = uint32_t(table);
+	node.length = uint32_t(length);
+	node.kind = sparse_table;
+}
+
+}} //namespace
+
+#endif //include guard
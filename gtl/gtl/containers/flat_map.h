@@ -0,0 +1,165 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_CONTAINERS_FLAT_MAP_H
+#define GTL_CONTAINERS_FLAT_MAP_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/scoped.h>
+#include <functional>
+#include <utility>
+#include "emplace.h"
+#include "flat_search.h"
+
+namespace gtl {
+
+template <class K, class V> struct Flat_Map_Entry
+{
+	typedef K key_type;
+
+	K key; //Must not be modified in place
+	V value;
+};
+
+	namespace details {
+
+struct Flat_Map_Key_Of
+{
+	template <class Entry> typename Entry::key_type const& operator()(Entry const& entry) const
+	{
+		return entry.key;
+	}
+};
+
+	} //details
+
+//Sorted map in a single Vector of entries, see Flat_Set
+template <class K, class V, class Less = std::less<K>, class Search = Binary_Search<K> >
+class Flat_Map : public details::Flat_Table<Flat_Map_Entry<K, V>, K, details::Flat_Map_Key_Of, Less, Search>
+{
+	typedef details::Flat_Table<Flat_Map_Entry<K, V>, K, details::Flat_Map_Key_Of, Less, Search> base_type;
+
+public:
+	typedef K key_type;
+	typedef V mapped_type;
+	typedef Flat_Map_Entry<K, V> value_type;
+	typedef typename base_type::range range;
+	typedef typename base_type::const_range const_range;
+
+	Flat_Map(Context const* context, Less const& less = Less()) :
+		base_type(context, less)
+	{
+	}
+
+	//Bulk construction from a range of entries, of duplicate keys only one
+	//entry is kept
+	template <class Range_T>
+	Flat_Map(Context const* context, Range_T range, Less const& less = Less()) :
+		base_type(context, less)
+	{
+		this->assign_range(range);
+	}
+
+	template <class Range_T>
+	void assign(Range_T range)
+	{
+		this->assign_range(range);
+	}
+
+	using base_type::all;
+
+	//Values may be modified in place, keys may not
+	range all() {return this->m_data.all();}
+
+	V* find(K const& key)
+	{
+		value_type* entry = this->find_element(key);
+		return entry ? &entry->value : 0;
+	}
+
+	V const* find(K const& key) const
+	{
+		value_type const* entry = this->find_element(key);
+		return entry ? &entry->value : 0;
+	}
+
+	bool contains(K const& key) const
+	{
+		return this->find_element(key) != 0;
+	}
+
+	//Missing values are value initialized, zero for scalars
+	V& operator[](K const& key)
+	{
+		return *func_emplace(key, [](V* p){new (p) V();}).first;
+	}
+
+	std::pair<V*, bool> insert(K const& key, V const& value)
+	{
+		return func_emplace(key, gtl::emplace(value));
+	}
+
+	template <class TT>
+	std::pair<V*, bool> emplace(K const& key, TT&& x)
+	{
+		return func_emplace(key, gtl::emplace(std::forward<TT>(x)));
+	}
+
+	//Constructs the value with func if key isn't present yet, returns the
+	//value for key and whether it was inserted
+	template <class Func_T>
+	std::pair<V*, bool> func_emplace(K const& key, Func_T func)
+	{
+		value_type const* position = this->lower_bound(key);
+		if(position != this->m_data.end() && !this->m_less(key, position->key))
+		{
+			return std::make_pair(&const_cast<value_type*>(position)->value, false);
+		}
+
+		value_type* entry = this->insert_element(position, Entry_Emplace<Func_T>(key, func));
+		return std::make_pair(&entry->value, true);
+	}
+
+	bool erase(K const& key)
+	{
+		return this->erase_element(key);
+	}
+
+private:
+	template <class Func_T> struct Entry_Emplace
+	{
+		Entry_Emplace(K const& key, Func_T func) : key(key), func(func) {}
+
+		void operator()(value_type* entry)
+		{
+			new (&entry->key) K(key);
+			auto guard = scope(&entry->key, [](K* p){destruct(p);});
+			func(&entry->value);
+			guard.release();
+		}
+
+		K const& key;
+		Func_T func;
+
+	private:
+		Entry_Emplace& operator=(Entry_Emplace const&);
+	};
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_CONTAINERS_FLAT_SEARCH_H
+#define GTL_CONTAINERS_FLAT_SEARCH_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <algorithm>
+#include "vector.h"
+
+namespace gtl {
+
+//Search policies for the flat containers.  rebuild is called with the
+//sorted contents after every modification, lower_bound returns the first
+//element not less than key, or last.
+
+//Plain std::lower_bound
+template <class K> struct Binary_Search
+{
+	Binary_Search(Context const*) {}
+
+	template <class T, class Key_Of>
+	void rebuild(T const*, T const*, Key_Of) {}
+
+	template <class T, class Key_Of, class Less>
+	T const* lower_bound(T const* first, T const* last, K const& key, Key_Of key_of, Less const& less) const
+	{
+		while(first != last)
+		{
+			size_t half = (last - first) / 2;
+			if(less(key_of(first[half]), key))
+			{
+				first += half + 1;
+			}
+			else
+			{
+				last = first + half;
+			}
+		}
+
+		return first;
+	}
+};
+
+//Halves the range without a data dependent branch, the compare compiles
+//down to a conditional move
+template <class K> struct Branchless_Search
+{
+	Branchless_Search(Context const*) {}
+
+	template <class T, class Key_Of>
+	void rebuild(T const*, T const*, Key_Of) {}
+
+	template <class T, class Key_Of, class Less>
+	T const* lower_bound(T const* first, T const* last, K const& key, Key_Of key_of, Less const& less) const
+	{
+		size_t n = last - first;
+		if(n == 0)
+		{
+			return last;
+		}
+
+		T const* base = first;
+		while(n > 1)
+		{
+			size_t half = n / 2;
+			base = less(key_of(base[half]), key) ? base + half : base;
+			n -= half;
+		}
+
+		return base + (less(key_of(*base), key) ? 1 : 0);
+	}
+};
+
+//Keeps a copy of the keys in breadth first (Eytzinger) order, so the first
+//levels of every search share the same few cache lines.  Costs a key and an
+//index per element, and an O(n) rebuild on every modification: meant for
+//read mostly tables.
+template <class K> class Eytzinger_Search
+{
+public:
+	Eytzinger_Search(Context const* context) :
+		m_tree(context),
+		m_index(context)
+	{
+	}
+
+	template <class T, class Key_Of>
+	void rebuild(T const* first, T const* last, Key_Of key_of)
+	{
+		m_tree.clear();
+		m_index.clear();
+
+		size_t n = last - first;
+		if(n == 0)
+		{
+			return;
+		}
+
+		//Slot 0 is unused, children of k are 2k and 2k + 1
+		m_tree.resize(n + 1, key_of(*first));
+		m_index.resize(n + 1, 0);
+
+		size_t i = 0;
+		fill(first, key_of, i, 1);
+	}
+
+	template <class T, class Key_Of, class Less>
+	T const* lower_bound(T const* first, T const* last, K const& key, Key_Of, Less const& less) const
+	{
+		size_t n = last - first;
+		GTL_ASSERT(n == 0 || n + 1 == m_tree.size());
+
+		size_t k = 1;
+		while(k <= n)
+		{
+			k = 2 * k + (less(m_tree[k], key) ? 1 : 0);
+		}
+
+		//Undo the right turns taken after the last left one
+		while(k & 1)
+		{
+			k >>= 1;
+		}
+		k >>= 1;
+
+		return k ? first + m_index[k] : last;
+	}
+
+private:
+	template <class T, class Key_Of>
+	void fill(T const* first, Key_Of key_of, size_t& i, size_t k)
+	{
+		if(k < m_tree.size())
+		{
+			fill(first, key_of, i, 2 * k);
+			m_tree[k] = key_of(first[i]);
+			m_index[k] = static_cast<uint32_t>(i);
+			++i;
+			fill(first, key_of, i, 2 * k + 1);
+		}
+	}
+
+private:
+	Vector<K> m_tree;
+	Vector<uint32_t> m_index;
+};
+
+	namespace details {
+
+//Sorted Vector of T, ordered by the key Key_Of extracts
+template <class T, class K, class Key_Of, class Less, class Search> class Flat_Table
+{
+public:
+	typedef Iterator_Range<T*> range;
+	typedef Iterator_Range<T const*> const_range;
+
+	Flat_Table(Context const* context, Less const& less) :
+		m_data(context),
+		m_search(context),
+		m_less(less)
+	{
+	}
+
+	size_t size() const {return m_data.size();}
+	bool empty() const {return m_data.empty();}
+
+	void reserve(size_t count)
+	{
+		m_data.reserve(count);
+	}
+
+	void clear()
+	{
+		m_data.clear();
+		rebuild();
+	}
+
+	const_range all() const {return m_data.all();}
+
+	//Elements with keys in [low, high)
+	const_range between(K const& low, K const& high) const
+	{
+		T const* first = lower_bound(low);
+		T const* last = lower_bound(high);
+		return const_range(first, std::max(first, last));
+	}
+
+	//Index of the first element not less than key
+	size_t lower_bound_index(K const& key) const
+	{
+		return lower_bound(key) - m_data.begin();
+	}
+
+protected:
+	T const* lower_bound(K const& key) const
+	{
+		return m_search.lower_bound(m_data.begin(), m_data.end(), key, Key_Of(), m_less);
+	}
+
+	T* find_element(K const& key)
+	{
+		T* element = const_cast<T*>(lower_bound(key));
+		return element != m_data.end() && !m_less(key, Key_Of()(*element)) ? element : 0;
+	}
+
+	T const* find_element(K const& key) const
+	{
+		return const_cast<Flat_Table*>(this)->find_element(key);
+	}
+
+	template <class Func_T>
+	T* insert_element(T const* position, Func_T func)
+	{
+		T* element = m_data.func_emplace(const_cast<T*>(position), func);
+		rebuild();
+		return element;
+	}
+
+	bool erase_element(K const& key)
+	{
+		T* element = find_element(key);
+		if(!element)
+		{
+			return false;
+		}
+
+		m_data.erase(element);
+		rebuild();
+		return true;
+	}
+
+	//Sorts once, then keeps a single element of every run of equal keys
+	template <class Range_T>
+	void assign_range(Range_T range)
+	{
+		m_data.clear();
+		for(; !range.empty(); range.pop())
+		{
+			m_data.push_back(range.get());
+		}
+
+		Less less = m_less;
+		Key_Of key_of;
+		std::sort(m_data.begin(), m_data.end(),
+			[&](T const& a, T const& b){return less(key_of(a), key_of(b));});
+
+		T* last = std::unique(m_data.begin(), m_data.end(),
+			[&](T const& a, T const& b){return !less(key_of(a), key_of(b));});
+		m_data.erase(last, m_data.end());
+
+		rebuild();
+	}
+
+	void rebuild()
+	{
+		m_search.rebuild(m_data.begin(), m_data.end(), Key_Of());
+	}
+
+	Vector<T> m_data;
+	Search m_search;
+	Less m_less;
+};
+
+	} //details
+
+} //namespace
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_CONTAINERS_FLAT_SET_H
+#define GTL_CONTAINERS_FLAT_SET_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <functional>
+#include "flat_search.h"
+
+namespace gtl {
+
+	namespace details {
+
+struct Flat_Set_Key_Of
+{
+	template <class K> K const& operator()(K const& key) const {return key;}
+};
+
+	} //details
+
+//Sorted set in a single Vector.  Inserts and erases shift the tail, lookups
+//go through the Search policy (Binary_Search, Branchless_Search or
+//Eytzinger_Search).
+template <class K, class Less = std::less<K>, class Search = Binary_Search<K> >
+class Flat_Set : public details::Flat_Table<K, K, details::Flat_Set_Key_Of, Less, Search>
+{
+	typedef details::Flat_Table<K, K, details::Flat_Set_Key_Of, Less, Search> base_type;
+
+public:
+	typedef K value_type;
+	typedef typename base_type::const_range const_range;
+
+	Flat_Set(Context const* context, Less const& less = Less()) :
+		base_type(context, less)
+	{
+	}
+
+	//Bulk construction, duplicates in range are dropped
+	template <class Range_T>
+	Flat_Set(Context const* context, Range_T range, Less const& less = Less()) :
+		base_type(context, less)
+	{
+		this->assign_range(range);
+	}
+
+	template <class Range_T>
+	void assign(Range_T range)
+	{
+		this->assign_range(range);
+	}
+
+	K const* find(K const& key) const
+	{
+		return this->find_element(key);
+	}
+
+	bool contains(K const& key) const
+	{
+		return this->find_element(key) != 0;
+	}
+
+	//Returns false if key was already present
+	bool insert(K const& key)
+	{
+		K const* position = this->lower_bound(key);
+		if(position != this->m_data.end() && !this->m_less(key, *position))
+		{
+			return false;
+		}
+
+		this->insert_element(position, gtl::emplace(key));
+		return true;
+	}
+
+	bool erase(K const& key)
+	{
+		return this->erase_element(key);
+	}
+};
+
+} //namespace
+
+#endif
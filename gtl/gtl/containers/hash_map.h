@@ -0,0 +1,435 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_CONTAINERS_HASH_MAP_H
+#define GTL_CONTAINERS_HASH_MAP_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/range.h>
+#include <gtl/scoped.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include "construct.h"
+#include "emplace.h"
+
+namespace gtl {
+
+template <class K, class V> struct Hash_Map_Entry
+{
+	K key; //Must not be modified in place
+	V value;
+};
+
+	namespace details {
+
+template <class Entry> struct Hash_Map_Slot
+{
+	typedef typename std::aligned_storage<sizeof(Entry), std::alignment_of<Entry>::value>::type storage_type;
+
+	//0 for empty, otherwise the distance from the home slot plus one
+	uint32_t distance;
+	storage_type storage;
+
+	Entry* entry() {return reinterpret_cast<Entry*>(&storage);}
+	Entry const* entry() const {return reinterpret_cast<Entry const*>(&storage);}
+};
+
+	} //details
+
+//Walks the occupied slots, the table ends in an occupied sentinel
+template <class Slot_T, class Entry_T> class Hash_Map_Iterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename std::remove_const<Entry_T>::type value_type;
+	typedef ptrdiff_t difference_type;
+	typedef Entry_T* pointer;
+	typedef Entry_T& reference;
+
+	Hash_Map_Iterator() : m_slot(0) {}
+	explicit Hash_Map_Iterator(Slot_T* slot) : m_slot(slot) {}
+
+	template <class S, class E>
+	Hash_Map_Iterator(Hash_Map_Iterator<S, E> const& other) : m_slot(other.m_slot) {}
+
+	reference operator*() const {return *m_slot->entry();}
+	pointer operator->() const {return m_slot->entry();}
+
+	Hash_Map_Iterator& operator++()
+	{
+		do
+		{
+			++m_slot;
+		} while(m_slot->distance == 0);
+
+		return *this;
+	}
+
+	Hash_Map_Iterator operator++(int)
+	{
+		Hash_Map_Iterator temp = *this;
+		++*this;
+		return temp;
+	}
+
+	bool operator==(Hash_Map_Iterator const& other) const {return m_slot == other.m_slot;}
+	bool operator!=(Hash_Map_Iterator const& other) const {return m_slot != other.m_slot;}
+
+	Slot_T* m_slot;
+};
+
+//Open addressing with Robin Hood probing.  Entries live inline in a power
+//of two table next to their probe distance, so a lookup usually touches a
+//single cache line.  Erase shifts the following run back instead of
+//leaving tombstones.
+//
+//Inserting or erasing moves entries around, pointers into the table are
+//only stable until the next modification.
+template <class K, class V, class Hash = std::hash<K>, class Equal = std::equal_to<K> >
+class Hash_Map : private Noncopyable
+{
+public:
+	typedef K key_type;
+	typedef V mapped_type;
+	typedef Hash_Map_Entry<K, V> value_type;
+
+	typedef details::Hash_Map_Slot<value_type> slot_type;
+	typedef Hash_Map_Iterator<slot_type, value_type> iterator;
+	typedef Hash_Map_Iterator<slot_type const, value_type const> const_iterator;
+	typedef Iterator_Range<iterator> range;
+	typedef Iterator_Range<const_iterator> const_range;
+
+	Hash_Map(Context const* context, Hash const& hash = Hash(), Equal const& equal = Equal()) :
+		m_context(context),
+		m_slots(0),
+		m_mask(0),
+		m_shift(0),
+		m_size(0),
+		m_hash(hash),
+		m_equal(equal)
+	{
+	}
+
+	Hash_Map(Hash_Map&& other) :
+		m_context(other.m_context),
+		m_slots(0),
+		m_mask(0),
+		m_shift(0),
+		m_size(0),
+		m_hash(other.m_hash),
+		m_equal(other.m_equal)
+	{
+		swap(other);
+	}
+
+	~Hash_Map()
+	{
+		clear();
+		deallocate(m_slots, capacity());
+	}
+
+	size_t size() const {return m_size;}
+	bool empty() const {return m_size == 0;}
+	size_t capacity() const {return m_slots ? m_mask + 1 : 0;}
+
+	iterator begin() {return iterator(first());}
+	const_iterator begin() const {return const_iterator(first());}
+	iterator end() {return iterator(m_slots + capacity());}
+	const_iterator end() const {return const_iterator(m_slots + capacity());}
+
+	range all() {return range(begin(), end());}
+	const_range all() const {return const_range(begin(), end());}
+
+	V* find(K const& key)
+	{
+		slot_type* slot = find_slot(key);
+		return slot ? &slot->entry()->value : 0;
+	}
+
+	V const* find(K const& key) const
+	{
+		slot_type const* slot = find_slot(key);
+		return slot ? &slot->entry()->value : 0;
+	}
+
+	bool contains(K const& key) const
+	{
+		return find(key) != 0;
+	}
+
+	//Missing values are value initialized, zero for scalars
+	V& operator[](K const& key)
+	{
+		return *func_emplace(key, [](V* p){new (p) V();}).first;
+	}
+
+	std::pair<V*, bool> insert(K const& key, V const& value)
+	{
+		return func_emplace(key, gtl::emplace(value));
+	}
+
+	template <class TT>
+	std::pair<V*, bool> emplace(K const& key, TT&& x)
+	{
+		return func_emplace(key, gtl::emplace(std::forward<TT>(x)));
+	}
+
+	//Constructs the value with func if key isn't present yet, returns the
+	//value for key and whether it was inserted
+	template <class Func_T>
+	std::pair<V*, bool> func_emplace(K const& key, Func_T func)
+	{
+		if(slot_type* slot = find_slot(key))
+		{
+			return std::make_pair(&slot->entry()->value, false);
+		}
+
+		//Built aside first, key may refer to an entry that is about to move
+		typename slot_type::storage_type storage;
+		value_type* entry = reinterpret_cast<value_type*>(&storage);
+		new (&entry->key) K(key);
+		{
+			auto key_guard = scope(&entry->key, [](K* p){destruct(p);});
+			func(&entry->value);
+			key_guard.release();
+		}
+		auto guard = scope(entry, [](value_type* p){destruct(p);});
+
+		if((m_size + 1) * 5 > capacity() * 4)
+		{
+			rehash(std::max(capacity() * 2, size_t(min_capacity)));
+		}
+
+		slot_type* slot = place(entry);
+		++m_size;
+		return std::make_pair(&slot->entry()->value, true);
+	}
+
+	bool erase(K const& key)
+	{
+		slot_type* slot = find_slot(key);
+		if(!slot)
+		{
+			return false;
+		}
+
+		destruct(slot->entry());
+
+		//Shift the rest of the run back, no tombstones
+		for(slot_type* next = advance(slot); next->distance > 1; next = advance(next))
+		{
+			new (slot->entry()) value_type(std::move(*next->entry()));
+			slot->distance = next->distance - 1;
+			destruct(next->entry());
+			slot = next;
+		}
+
+		slot->distance = 0;
+		--m_size;
+		return true;
+	}
+
+	void clear()
+	{
+		for(size_t i = 0; i < capacity(); ++i)
+		{
+			if(m_slots[i].distance)
+			{
+				destruct(m_slots[i].entry());
+				m_slots[i].distance = 0;
+			}
+		}
+
+		m_size = 0;
+	}
+
+	//Makes room for count entries without rehashing
+	void reserve(size_t count)
+	{
+		size_t len = min_capacity;
+		while(count * 5 > len * 4)
+		{
+			len *= 2;
+		}
+
+		if(len > capacity())
+		{
+			rehash(len);
+		}
+	}
+
+	void swap(Hash_Map& other)
+	{
+		std::swap(m_context, other.m_context);
+		std::swap(m_slots, other.m_slots);
+		std::swap(m_mask, other.m_mask);
+		std::swap(m_shift, other.m_shift);
+		std::swap(m_size, other.m_size);
+		std::swap(m_hash, other.m_hash);
+		std::swap(m_equal, other.m_equal);
+	}
+
+private:
+	static size_t const min_capacity = 8;
+
+	//Fibonacci hashing, the top bits pick the slot so weak hashes
+	//(like identity on integers) still spread
+	size_t home(K const& key) const
+	{
+		uint64_t mixed = static_cast<uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(mixed >> m_shift);
+	}
+
+	slot_type* advance(slot_type* slot) const
+	{
+		return slot == m_slots + m_mask ? m_slots : slot + 1;
+	}
+
+	slot_type* first() const
+	{
+		slot_type* slot = m_slots;
+		if(slot)
+		{
+			while(slot->distance == 0)
+			{
+				++slot;
+			}
+		}
+
+		return slot;
+	}
+
+	slot_type* find_slot(K const& key) const
+	{
+		if(m_size == 0)
+		{
+			return 0;
+		}
+
+		slot_type* slot = m_slots + home(key);
+		for(uint32_t distance = 1; ; ++distance)
+		{
+			//Anything richer than us means the key would have been placed by now
+			if(slot->distance < distance)
+			{
+				return 0;
+			}
+
+			if(slot->distance == distance && m_equal(slot->entry()->key, key))
+			{
+				return slot;
+			}
+
+			slot = advance(slot);
+		}
+	}
+
+	//Moves entry into the table, returns where it ended up
+	slot_type* place(value_type* entry)
+	{
+		slot_type* result = 0;
+		slot_type* slot = m_slots + home(entry->key);
+
+		for(uint32_t distance = 1; ; ++distance)
+		{
+			if(slot->distance == 0)
+			{
+				new (slot->entry()) value_type(std::move(*entry));
+				slot->distance = distance;
+				return result ? result : slot;
+			}
+
+			//Take from the rich, carry on placing the displaced entry
+			if(slot->distance < distance)
+			{
+				std::swap(*entry, *slot->entry());
+				std::swap(distance, slot->distance);
+				if(!result)
+				{
+					result = slot;
+				}
+			}
+
+			slot = advance(slot);
+		}
+	}
+
+	void rehash(size_t len)
+	{
+		slot_type* old_slots = m_slots;
+		size_t old_capacity = capacity();
+
+		m_slots = allocate(len);
+		m_mask = len - 1;
+		m_shift = 64;
+		for(size_t i = len; i > 1; i >>= 1)
+		{
+			--m_shift;
+		}
+
+		for(size_t i = 0; i < old_capacity; ++i)
+		{
+			if(old_slots[i].distance)
+			{
+				place(old_slots[i].entry());
+				destruct(old_slots[i].entry());
+			}
+		}
+
+		deallocate(old_slots, old_capacity);
+	}
+
+	//One extra occupied slot stops iteration at the end
+	slot_type* allocate(size_t len)
+	{
+		slot_type* slots = static_cast<slot_type*>(m_context->allocator->allocate(
+			sizeof(slot_type) * (len + 1), std::alignment_of<slot_type>::value));
+
+		for(size_t i = 0; i < len; ++i)
+		{
+			slots[i].distance = 0;
+		}
+		slots[len].distance = 1;
+
+		return slots;
+	}
+
+	void deallocate(slot_type* slots, size_t len)
+	{
+		if(slots)
+		{
+			m_context->allocator->deallocate(slots,
+				sizeof(slot_type) * (len + 1), std::alignment_of<slot_type>::value);
+		}
+	}
+
+private:
+	Context const* m_context;
+	slot_type* m_slots;
+	size_t m_mask;
+	unsigned int m_shift;
+	size_t m_size;
+	Hash m_hash;
+	Equal m_equal;
+};
+
+} //namespace
+
+#endif
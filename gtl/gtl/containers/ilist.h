@@ -29,6 +29,7 @@
 #define GTL_CONTAINERS_ILIST_H
 
 #include <gtl/common.h>
+#include <gtl/debug.h>
 #include "list_base.h"
 
 namespace gtl {
@@ -138,7 +139,7 @@ public:
 	typedef Ilist_Range<T, List_Reverse_Range_Base, T, Tag> reverse_range;
 	typedef Ilist_Range<T, List_Reverse_Range_Base, T const, Tag> const_reverse_range;
 
-	Ilist()
+	Ilist() : m_size(0)
 	{
 		m_node.next = &m_node;
 		m_node.prev = &m_node;
@@ -183,10 +184,7 @@ public:
 
 	bool empty() const { return m_node.next == &m_node; }
 
-	size_type size() const {
-		size_type result = std::distance(begin(), end());
-		return result;
-	}
+	size_type size() const {return m_size;}
 
 	size_type max_size() const { return size_type(-1); }
 
@@ -200,12 +198,17 @@ public:
 		return iterator(static_cast<node_t*>(&x));
 	}
 
-	void swap(Ilist<T, Tag>& x) {std::swap(m_node, x.m_node);}
+	void swap(Ilist<T, Tag>& x)
+	{
+		swap_chains(m_node, x.m_node);
+		std::swap(m_size, x.m_size);
+	}
 
 	iterator insert(iterator position, T& x)
 	{
 		node_t* node = &x;
 		insert_before(position.m_node, node);
+		++m_size;
 		return node;
 	}
 
@@ -224,6 +227,7 @@ public:
 	iterator erase(iterator position)
 	{
 		List_Node_Base* next_node = gtl::erase(position.m_node);
+		--m_size;
 		return iterator(static_cast<node_t*>(next_node));
 	}
 
@@ -246,24 +250,44 @@ public:
 	{
 		m_node.next = &m_node;
 		m_node.prev = &m_node;
+		m_size = 0;
 	}
 
 	void splice(iterator position, Ilist& x)
 	{
 		if (!x.empty()) 
+		{
 			transfer(position.m_node, x.begin().m_node, x.end().m_node);
+			m_size += x.m_size;
+			x.m_size = 0;
+		}
 	}
 
-	void splice(iterator position, Ilist&, iterator i) {
+	void splice(iterator position, Ilist& x, iterator i) {
 		iterator j = i;
 		++j;
 		if (position == i || position == j) return;
 		transfer(position.m_node, i.m_node, j.m_node);
+		++m_size;
+		--x.m_size;
+	}
+
+	//Counts [first, last) to keep the sizes, use the overload taking the
+	//count if it's known
+	void splice(iterator position, Ilist& x, iterator first, iterator last) {
+		size_type count = &x != this ? std::distance(first, last) : 0;
+		splice(position, x, first, last, count);
 	}
 
-	void splice(iterator position, Ilist&, iterator first, iterator last) {
+	//count is the length of [first, last), or 0 when splicing within the list
+	void splice(iterator position, Ilist& x, iterator first, iterator last, size_type count) {
+		GTL_ASSERT(count == (&x != this ? size_type(std::distance(first, last)) : 0));
 		if (first != last) 
+		{
 			transfer(position.m_node, first.m_node, last.m_node);
+			m_size += count;
+			x.m_size -= count;
+		}
 	}
 
 private:
@@ -272,6 +296,7 @@ private:
 
 private:
 	node_t m_node;
+	size_type m_size;
 };
 
 template <class T, class Tag>
@@ -19,7 +19,10 @@
 
 #include <gtl/common.h>
 #include <gtl/context.h>
+#include <gtl/debug.h>
 #include <gtl/type_traits.h>
+#include <gtl/pool/pool.h>
+#include <cstddef>
 #include "list_base.h"
 
 namespace gtl {
@@ -34,6 +37,13 @@ template <class T> struct List_Node_T : public List_Node_Base
 	T* ptr() {return reinterpret_cast<T*>(&data);}
 };
 
+//Pooled nodes keep the free list in their next pointer, so a whole list
+//can be handed back as is
+template <class T> struct pool_link_offset<List_Node_T<T>> :
+	std::integral_constant<size_t, offsetof(List_Node_Base, next)>
+{
+};
+
 template <class T, class Ref, class Ptr>
 	struct List_Iterator : public List_Iterator_Base
 {
@@ -131,7 +141,15 @@ public:
 	typedef List_Range<T, List_Reverse_Range_Base, T> reverse_range;
 	typedef List_Range<T, List_Reverse_Range_Base, T const> const_reverse_range;
 
-	List(Context const* context) : m_context(context)
+	List(Context const* context) : m_context(context), m_pool(0), m_size(0)
+	{
+		m_node.next = &m_node;
+		m_node.prev = &m_node;
+	}
+
+	//Nodes come from pool instead of the context allocator.  The pool must
+	//outlive the list, and nodes only move between lists sharing it.
+	List(Context const* context, Node_Pool<node_type>* pool) : m_context(context), m_pool(pool), m_size(0)
 	{
 		m_node.next = &m_node;
 		m_node.prev = &m_node;
@@ -179,10 +197,7 @@ public:
 
 	bool empty() const { return m_node.next == &m_node; }
 
-	size_type size() const {
-		size_type result = std::distance(begin(), end());
-		return result;
-	}
+	size_type size() const {return m_size;}
 
 	size_type max_size() const { return size_type(-1); }
 
@@ -194,7 +209,9 @@ public:
 	void swap(List<T>& x)
 	{
 		std::swap(m_context, x.m_context);
-		std::swap(m_node, x.m_node);
+		std::swap(m_pool, x.m_pool);
+		swap_chains(m_node, x.m_node);
+		std::swap(m_size, x.m_size);
 	}
 	
 	iterator insert(iterator position, T const& x)
@@ -218,6 +235,7 @@ public:
 		//Now place the actual data
 		func(node.get()->ptr());
 		insert_before(position.m_node, node.get());
+		++m_size;
 		return node.release();
 	}
 
@@ -240,15 +258,17 @@ public:
 	void emplace_back(TT& x) {func_emplace(end(), gtl::emplace(x));}
 
 	template <class Emplace_T>
-	void func_emplace_front(Emplace_T func) {insert(begin(), func);}
+	void func_emplace_front(Emplace_T func) {func_emplace(begin(), func);}
 
 	template <class Emplace_T>
-	void func_emplace_back(Emplace_T func) {insert(end(), func);}
+	void func_emplace_back(Emplace_T func) {func_emplace(end(), func);}
 
 	iterator erase(iterator position)
 	{
 		node_type* node = static_cast<node_type*>(position.m_node);
 		List_Node_Base* next_node = gtl::erase(position.m_node);
+		--m_size;
+		destruct(node->ptr());
 		destruct(node);
 		dealloc_node(node);
 		return iterator(static_cast<node_type*>(next_node));
@@ -270,7 +290,11 @@ public:
 	{
 		verify_transferrable(x);
 		if (!x.empty()) 
+		{
 			transfer(position.m_node, x.begin().m_node, x.end().m_node);
+			m_size += x.m_size;
+			x.m_size = 0;
+		}
 	}
 
 	void splice(iterator position, List& x, iterator i)
@@ -280,13 +304,29 @@ public:
 		++j;
 		if (position == i || position == j) return;
 		transfer(position.m_node, i.m_node, j.m_node);
+		++m_size;
+		--x.m_size;
 	}
 
+	//Counts [first, last) to keep the sizes, use the overload taking the
+	//count if it's known
 	void splice(iterator position, List& x, iterator first, iterator last)
+	{
+		size_type count = &x != this ? std::distance(first, last) : 0;
+		splice(position, x, first, last, count);
+	}
+
+	//count is the length of [first, last), or 0 when splicing within the list
+	void splice(iterator position, List& x, iterator first, iterator last, size_type count)
 	{
 		verify_transferrable(x);
+		GTL_ASSERT(count == (&x != this ? size_type(std::distance(first, last)) : 0));
 		if (first != last) 
+		{
 			transfer(position.m_node, first.m_node, last.m_node);
+			m_size += count;
+			x.m_size -= count;
+		}
 	}
 
 private:
@@ -295,17 +335,57 @@ private:
 
 	node_type* alloc_node()
 	{
-		return static_cast<node_type*>(m_context->allocator->allocate(sizeof(node_type)));
+		if(m_pool)
+		{
+			return m_pool->allocate();
+		}
+
+		return static_cast<node_type*>(m_context->allocator->allocate(
+			sizeof(node_type), std::alignment_of<node_type>::value));
 	}
 
 	void dealloc_node(node_type* p)
 	{
-		m_context->allocator->deallocate(p);
+		if(m_pool)
+		{
+			m_pool->deallocate(p);
+		}
+		else
+		{
+			m_context->allocator->deallocate(p, sizeof(node_type), std::alignment_of<node_type>::value);
+		}
+	}
+
+	void clear_aux(true_type /*trivial*/)
+	{
+		if(m_pool && !empty())
+		{
+			//Already chained through next, O(1)
+			m_pool->deallocate_chain(
+				static_cast<node_type*>(m_node.next), static_cast<node_type*>(m_node.prev), m_size);
+		}
+		else
+		{
+			clear_aux(false_type());
+		}
+	}
+
+	void clear_aux(false_type /*trivial*/)
+	{
+		List_Node_Base* current = m_node.next;
+		while(current != &m_node)
+		{
+			node_type* node = static_cast<node_type*>(current);
+			current = current->next;
+			destruct(node->ptr());
+			destruct(node);
+			dealloc_node(node);
+		}
 	}
 
 	void verify_transferrable(List& other)
 	{
-		if(m_context->allocator != other.m_context->allocator)
+		if(m_pool != other.m_pool || (!m_pool && m_context->allocator != other.m_context->allocator))
 		{
 			raise_exception(Exception("nodes cannot be transferred"));
 		}
@@ -313,7 +393,9 @@ private:
 
 private:
 	Context const* m_context;
+	Node_Pool<node_type>* m_pool;
 	List_Node_Base m_node;
+	size_type m_size;
 };
 
 template <class T>
@@ -337,17 +419,11 @@ typename List<T>::iterator List<T>::erase(iterator first, iterator last)
 template <class T>
 void List<T>::clear()
 {
-	List_Node_Base* current = m_node.next;
-	while(current != &m_node)
-	{
-		node_type* node = static_cast<node_type*>(current);
-		current = current->next;
-		destruct(node);
-		dealloc_node(node);
-	}
+	clear_aux(typename std::has_trivial_destructor<T>::type());
 
 	m_node.next = &m_node;
 	m_node.prev = &m_node;
+	m_size = 0;
 }
 
 } //namespace
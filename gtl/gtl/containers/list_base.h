@@ -139,6 +139,39 @@ inline void transfer(List_Node_Base* position, List_Node_Base* first, List_Node_
 	}
 }
 
+//Exchanges the chains hanging off two sentinel nodes
+inline void swap_chains(List_Node_Base& a, List_Node_Base& b)
+{
+	List_Node_Base* a_next = a.next;
+	List_Node_Base* a_prev = a.prev;
+	List_Node_Base* b_next = b.next;
+	List_Node_Base* b_prev = b.prev;
+
+	if(b_next == &b)
+	{
+		a.next = a.prev = &a;
+	}
+	else
+	{
+		a.next = b_next;
+		a.prev = b_prev;
+		b_next->prev = &a;
+		b_prev->next = &a;
+	}
+
+	if(a_next == &a)
+	{
+		b.next = b.prev = &b;
+	}
+	else
+	{
+		b.next = a_next;
+		b.prev = a_prev;
+		a_next->prev = &b;
+		a_prev->next = &b;
+	}
+}
+
 } //namespace
 
 #endif
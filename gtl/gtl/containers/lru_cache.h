@@ -0,0 +1,352 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_LRU_CACHE_H
+#define GTL_CONTAINERS_LRU_CACHE_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/scoped.h>
+#include <gtl/pool/pool.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include "construct.h"
+#include "emplace.h"
+#include "hash_map.h"
+#include "ilist.h"
+
+namespace gtl {
+
+template <class K, class V> struct Lru_Cache_Entry : public Ilist_Node
+{
+	Lru_Cache_Entry(K const& key, size_t bytes) : key(key), bytes(bytes) {}
+
+	V* value() {return reinterpret_cast<V*>(&data);}
+
+	K key;
+	size_t bytes;
+	typename std::aligned_storage<sizeof(V), std::alignment_of<V>::value>::type data;
+};
+
+struct Lru_Ignore_Evict
+{
+	template <class K, class V>
+	void operator()(K const&, V&) const {}
+};
+
+//Bounded map dropping the least recently used entries once over either
+//limit.  Entries sit in an intrusive recency list, most recent first, and
+//are found through a Hash_Map index.  A hit only relinks the entry.
+//
+//Values stay put until erased or evicted, but any insert may evict.  The
+//newest entry is always kept, even if it alone exceeds max_bytes.  evict
+//is called with each entry pushed out by the limits, just before it goes.
+template <class K, class V, class Evict = Lru_Ignore_Evict,
+	class Hash = std::hash<K>, class Equal = std::equal_to<K> >
+class Lru_Cache : private Noncopyable
+{
+public:
+	typedef Lru_Cache_Entry<K, V> entry_type;
+	typedef Ilist<entry_type> list_type;
+	typedef typename list_type::range range;
+	typedef typename list_type::const_range const_range;
+
+	Lru_Cache(Context const* context, size_t max_entries, size_t max_bytes = size_t(-1),
+		Evict const& evict = Evict(), Hash const& hash = Hash(), Equal const& equal = Equal()) :
+		m_pool(context, Pool_Policy(16).grow(2.0f, 1024)),
+		m_index(context, hash, equal),
+		m_max_entries(std::max(max_entries, size_t(1))),
+		m_max_bytes(max_bytes),
+		m_bytes(0),
+		m_evict(evict)
+	{
+	}
+
+	~Lru_Cache()
+	{
+		clear();
+	}
+
+	size_t size() const {return m_order.size();}
+	bool empty() const {return m_order.empty();}
+	size_t bytes() const {return m_bytes;}
+
+	//Most recently used first
+	range all() {return m_order.all();}
+	const_range all() const {return m_order.all();}
+
+	//Marks the entry as most recently used, 0 if missing
+	V* get(K const& key)
+	{
+		entry_type** entry = m_index.find(key);
+		if(!entry)
+		{
+			return 0;
+		}
+
+		touch(*entry);
+		return (*entry)->value();
+	}
+
+	//Looks up without touching the recency order
+	V* peek(K const& key)
+	{
+		entry_type** entry = m_index.find(key);
+		return entry ? (*entry)->value() : 0;
+	}
+
+	std::pair<V*, bool> insert(K const& key, V const& value, size_t bytes = 0)
+	{
+		return func_emplace(key, gtl::emplace(value), bytes);
+	}
+
+	template <class TT>
+	std::pair<V*, bool> emplace(K const& key, TT&& x, size_t bytes = 0)
+	{
+		return func_emplace(key, gtl::emplace(std::forward<TT>(x)), bytes);
+	}
+
+	//Constructs the value with func if key isn't cached yet, charging bytes
+	//against max_bytes.  Either way the entry becomes the most recent.
+	template <class Func_T>
+	std::pair<V*, bool> func_emplace(K const& key, Func_T func, size_t bytes = 0);
+
+	bool erase(K const& key)
+	{
+		entry_type** entry = m_index.find(key);
+		if(!entry)
+		{
+			return false;
+		}
+
+		remove(*entry);
+		return true;
+	}
+
+	//Drops everything without calling evict
+	void clear()
+	{
+		while(!m_order.empty())
+		{
+			remove(&m_order.back());
+		}
+	}
+
+	//Evicts right away if the cache is over the new limits
+	void set_limits(size_t max_entries, size_t max_bytes = size_t(-1))
+	{
+		m_max_entries = std::max(max_entries, size_t(1));
+		m_max_bytes = max_bytes;
+		trim();
+	}
+
+private:
+	typedef Hash_Map<K, entry_type*, Hash, Equal> index_type;
+
+	void touch(entry_type* entry)
+	{
+		m_order.splice(m_order.begin(), m_order, m_order.get_iterator(*entry));
+	}
+
+	void remove(entry_type* entry)
+	{
+		m_index.erase(entry->key);
+		m_order.erase(*entry);
+		m_bytes -= entry->bytes;
+		destruct(entry->value());
+		m_pool.destroy(entry);
+	}
+
+	void trim()
+	{
+		while(m_order.size() > 1 && (m_order.size() > m_max_entries || m_bytes > m_max_bytes))
+		{
+			entry_type* entry = &m_order.back();
+			m_evict(entry->key, *entry->value());
+			remove(entry);
+		}
+	}
+
+private:
+	Node_Pool<entry_type> m_pool;
+	index_type m_index;
+	list_type m_order;
+	size_t m_max_entries;
+	size_t m_max_bytes;
+	size_t m_bytes;
+	Evict m_evict;
+};
+
+template <class K, class V, class Evict, class Hash, class Equal>
+template <class Func_T>
+std::pair<V*, bool> Lru_Cache<K, V, Evict, Hash, Equal>::func_emplace(K const& key, Func_T func, size_t bytes)
+{
+	if(entry_type** found = m_index.find(key))
+	{
+		touch(*found);
+		return std::make_pair((*found)->value(), false);
+	}
+
+	entry_type* entry = m_pool.create(gtl::emplace(key, bytes));
+	auto guard = scope(entry, [this](entry_type* p){this->m_pool.destroy(p);});
+	func(entry->value());
+	auto value_guard = scope(entry->value(), [](V* p){destruct(p);});
+
+	m_index.insert(entry->key, entry);
+	value_guard.release();
+	guard.release();
+
+	m_order.push_front(*entry);
+	m_bytes += bytes;
+	trim();
+	return std::make_pair(entry->value(), true);
+}
+
+//Splits the key space over independently locked caches, so threads working
+//on different keys rarely contend.  Limits apply per shard (total divided by
+//the shard count), evict runs with the shard locked.
+template <class K, class V, class Evict = Lru_Ignore_Evict,
+	class Hash = std::hash<K>, class Equal = std::equal_to<K> >
+class Sharded_Lru_Cache : private Noncopyable
+{
+public:
+	typedef Lru_Cache<K, V, Evict, Hash, Equal> cache_type;
+
+	Sharded_Lru_Cache(Context const* context, size_t shard_count, size_t max_entries,
+		size_t max_bytes = size_t(-1), Evict const& evict = Evict(),
+		Hash const& hash = Hash(), Equal const& equal = Equal()) :
+		m_context(context),
+		m_shards(0),
+		m_shard_count(std::max(shard_count, size_t(1))),
+		m_hash(hash)
+	{
+		size_t entries = (max_entries + m_shard_count - 1) / m_shard_count;
+		size_t bytes = max_bytes == size_t(-1) ? max_bytes : (max_bytes + m_shard_count - 1) / m_shard_count;
+
+		m_shards = static_cast<Shard*>(m_context->allocator->allocate(
+			sizeof(Shard) * m_shard_count, std::alignment_of<Shard>::value));
+
+		size_t built = 0;
+		GTL_TRY
+		{
+			for(; built < m_shard_count; ++built)
+			{
+				new (m_shards + built) Shard(context, entries, bytes, evict, hash, equal);
+			}
+		}
+		GTL_UNWIND(destroy(built))
+	}
+
+	~Sharded_Lru_Cache()
+	{
+		destroy(m_shard_count);
+	}
+
+	//Copies the value out, marking it most recently used in its shard
+	bool get(K const& key, V& value)
+	{
+		Shard& shard = shard_of(key);
+		std::lock_guard<std::mutex> lock(shard.lock);
+		if(V* found = shard.cache.get(key))
+		{
+			value = *found;
+			return true;
+		}
+		return false;
+	}
+
+	//Returns false if key was already cached, which leaves its value alone
+	bool insert(K const& key, V const& value, size_t bytes = 0)
+	{
+		Shard& shard = shard_of(key);
+		std::lock_guard<std::mutex> lock(shard.lock);
+		return shard.cache.insert(key, value, bytes).second;
+	}
+
+	bool erase(K const& key)
+	{
+		Shard& shard = shard_of(key);
+		std::lock_guard<std::mutex> lock(shard.lock);
+		return shard.cache.erase(key);
+	}
+
+	void clear()
+	{
+		for(size_t i = 0; i < m_shard_count; ++i)
+		{
+			std::lock_guard<std::mutex> lock(m_shards[i].lock);
+			m_shards[i].cache.clear();
+		}
+	}
+
+	//Shards are counted one after the other, not as one snapshot
+	size_t size()
+	{
+		size_t total = 0;
+		for(size_t i = 0; i < m_shard_count; ++i)
+		{
+			std::lock_guard<std::mutex> lock(m_shards[i].lock);
+			total += m_shards[i].cache.size();
+		}
+		return total;
+	}
+
+	size_t shard_count() const {return m_shard_count;}
+
+private:
+	//A line of its own, neighbouring locks don't share a cache line
+	struct GTL_ALIGNAS(64) Shard
+	{
+		Shard(Context const* context, size_t entries, size_t bytes,
+			Evict const& evict, Hash const& hash, Equal const& equal) :
+			cache(context, entries, bytes, evict, hash, equal)
+		{
+		}
+
+		std::mutex lock;
+		cache_type cache;
+	};
+
+	Shard& shard_of(K const& key)
+	{
+		//Mixed and taken from the middle, the caches index by the top bits
+		size_t mixed = m_hash(key) * size_t(2654435769u);
+		return m_shards[(mixed >> (sizeof(size_t) * 4)) % m_shard_count];
+	}
+
+	void destroy(size_t count)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			destruct(m_shards + i);
+		}
+		m_context->allocator->deallocate(m_shards, sizeof(Shard) * m_shard_count, std::alignment_of<Shard>::value);
+	}
+
+private:
+	Context const* m_context;
+	Shard* m_shards;
+	size_t m_shard_count;
+	Hash m_hash;
+};
+
+} //namespace
+
+#endif
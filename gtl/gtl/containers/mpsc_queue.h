@@ -0,0 +1,142 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_MPSC_QUEUE_H
+#define GTL_CONTAINERS_MPSC_QUEUE_H
+
+#include <gtl/common.h>
+#include <gtl/noncopyable.h>
+#include <atomic>
+#include "ilist.h"
+
+namespace gtl {
+
+//Lock-free queue filled by any number of threads and drained by one.
+//Elements link through the same Ilist_Node_T<Tag> hook as Ilist, so
+//queueing allocates nothing, and drained elements come out as an Ilist.
+//
+//Producers push onto a single atomic head, the consumer takes the whole
+//chain with one exchange and puts it back in push order.  Nothing is ever
+//popped off the head by compare and swap, so there is no ABA hazard.
+template <class T, class Tag = void> class Mpsc_Queue : private Noncopyable
+{
+public:
+	typedef Ilist_Node_T<Tag> node_t;
+	typedef Ilist<T, Tag> list_type;
+
+	Mpsc_Queue() : m_head(0) {}
+
+	//Any thread.  Returns true if the queue was empty, so the consumer
+	//only needs waking up then.
+	bool push(T& x)
+	{
+		node_t* node = &x;
+		List_Node_Base* head = m_head.load(std::memory_order_relaxed);
+		do
+		{
+			node->next = head;
+		}
+		while(!m_head.compare_exchange_weak(head, node,
+			std::memory_order_release, std::memory_order_relaxed));
+
+		return head == 0;
+	}
+
+	//Any thread.  Queues all of list in order with a single publish.
+	bool push_all(list_type& list)
+	{
+		if(list.empty())
+		{
+			return false;
+		}
+
+		//The chain runs newest first, which is what prev already links
+		List_Node_Base* newest = list.end().m_node->prev;
+		List_Node_Base* oldest = list.begin().m_node;
+		for(List_Node_Base* node = newest; node != oldest; node = node->prev)
+		{
+			node->next = node->prev;
+		}
+		list.clear();
+
+		List_Node_Base* head = m_head.load(std::memory_order_relaxed);
+		do
+		{
+			oldest->next = head;
+		}
+		while(!m_head.compare_exchange_weak(head, newest,
+			std::memory_order_release, std::memory_order_relaxed));
+
+		return head == 0;
+	}
+
+	//Whether anything waits to be drained, not counting the batch pop()
+	//holds.  May be stale by the time it returns.
+	bool empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == 0;
+	}
+
+	//Consumer only.  Appends everything queued so far to the end of list,
+	//oldest first, and returns how many were taken.
+	size_t pop_all(list_type& list)
+	{
+		size_t count = m_batch.size();
+		list.splice(list.end(), m_batch);
+		return count + take(list);
+	}
+
+	//Consumer only.  Refills a private batch when it runs out, so most pops
+	//touch no shared state.  Returns 0 when nothing is queued.
+	T* pop()
+	{
+		if(m_batch.empty() && !take(m_batch))
+		{
+			return 0;
+		}
+
+		T* x = &m_batch.front();
+		m_batch.pop_front();
+		return x;
+	}
+
+private:
+	size_t take(list_type& list)
+	{
+		List_Node_Base* chain = m_head.exchange(0, std::memory_order_acquire);
+
+		size_t count = 0;
+		typename list_type::iterator position = list.end();
+		while(chain)
+		{
+			List_Node_Base* next = chain->next;
+			position = list.insert(position, *static_cast<T*>(static_cast<node_t*>(chain)));
+			chain = next;
+			++count;
+		}
+
+		return count;
+	}
+
+private:
+	std::atomic<List_Node_Base*> m_head;
+	list_type m_batch;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_RADIX_REGISTRY_H
+#define GTL_CONTAINERS_RADIX_REGISTRY_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/containers/vector.h>
+#include <gtl/containers/hash_map.h>
+#include <gtl/range.h>
+#include <cstring>
+#include "registry.h"
+
+namespace gtl { namespace registry {
+
+//Registry with single child chains collapsed into one node, labelled with
+//the run of indices it stands for.  A lookup does one hash probe per node
+//and compares the whole label at once, with memcmp when the path is a
+//contiguous range (like Fixed_Path::get).
+//
+//Only paths passed to get_path are found again.  Their prefixes aren't,
+//unlike with Node, as most of them have no node of their own.  Nodes live
+//in one array, ids stay valid until clear() but data moves as it grows.
+template <class T, class Index = unsigned int> class Radix_Registry : private Noncopyable
+{
+public:
+	typedef Index index_t;
+	typedef Iterator_Range<index_t const*> label_range;
+
+	static node_id const root = 0;
+	static node_id const missing = node_id(-1);
+
+	//Yields the node_id of each child
+	class Child_Range
+	{
+	public:
+		typedef node_id get_type;
+
+		Child_Range(Radix_Registry const* registry, node_id first) : m_registry(registry), m_node(first) {}
+
+		get_type get() const {return m_node;}
+		void pop() {m_node = m_registry->m_nodes[m_node].next_sibling;}
+		bool empty() const {return m_node == missing;}
+
+	private:
+		Radix_Registry const* m_registry;
+		node_id m_node;
+	};
+
+	Radix_Registry(Context const* context) :
+		m_nodes(context),
+		m_labels(context),
+		m_edges(context),
+		m_size(1)
+	{
+		m_nodes.push_back(Radix_Node(missing, 0, 0));
+		m_nodes[root].present = true;
+	}
+
+	void clear()
+	{
+		m_nodes.clear();
+		m_labels.clear();
+		m_edges.clear();
+		m_nodes.push_back(Radix_Node(missing, 0, 0));
+		m_nodes[root].present = true;
+		m_size = 1;
+	}
+
+	//Paths stored, the root included
+	size_t size() const {return m_size;}
+	size_t node_count() const {return m_nodes.size();}
+
+	T& data(node_id node) {return m_nodes[node].data;}
+	T const& data(node_id node) const {return m_nodes[node].data;}
+
+	//The run of indices leading to node from its parent
+	label_range label(node_id node) const
+	{
+		Radix_Node const& radix = m_nodes[node];
+		index_t const* first = m_labels.begin() + radix.label;
+		return label_range(first, first + radix.length);
+	}
+
+	Child_Range children(node_id node) const
+	{
+		return Child_Range(this, m_nodes[node].first_child);
+	}
+
+	template <class Range_T> node_id get_path(Range_T path);
+
+	template <class Range_T> node_id try_get_path(Range_T path) const
+	{
+		node_id current = root;
+
+		while(!path.empty())
+		{
+			node_id const* child = m_edges.find(edge_key(current, path.get()));
+			if(!child)
+			{
+				return missing;
+			}
+
+			Radix_Node const& node = m_nodes[*child];
+			if(!starts_with(path, m_labels.begin() + node.label, node.length))
+			{
+				return missing;
+			}
+
+			advance(path, node.length);
+			current = *child;
+		}
+
+		return m_nodes[current].present ? current : missing;
+	}
+
+private:
+	struct Radix_Node
+	{
+		Radix_Node(node_id parent, size_t label, size_t length) :
+			parent(parent), label(uint32_t(label)), length(uint32_t(length)),
+			first_child(missing), next_sibling(missing), present(false), data()
+		{
+		}
+
+		node_id parent;
+		uint32_t label;
+		uint32_t length;
+		node_id first_child;
+		node_id next_sibling;
+		bool present;
+		T data;
+	};
+
+	static uint64_t edge_key(node_id parent, index_t first)
+	{
+		static_assert(sizeof(index_t) <= sizeof(uint32_t), "edges are keyed by parent and a 32-bit index");
+		return (uint64_t(parent) << 32) | uint32_t(first);
+	}
+
+	template <class Range_T>
+	static bool starts_with(Range_T path, index_t const* label, size_t length)
+	{
+		for(size_t i = 0; i < length; ++i, path.pop())
+		{
+			if(path.empty() || path.get() != label[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool starts_with(Iterator_Range<index_t const*> path, index_t const* label, size_t length)
+	{
+		return path.size() >= length && std::memcmp(path.begin(), label, length * sizeof(index_t)) == 0;
+	}
+
+	static bool starts_with(Iterator_Range<index_t*> path, index_t const* label, size_t length)
+	{
+		return starts_with(Iterator_Range<index_t const*>(path), label, length);
+	}
+
+	template <class Range_T>
+	static void advance(Range_T& path, size_t n)
+	{
+		for(; n > 0; --n)
+		{
+			path.pop();
+		}
+	}
+
+	template <class P>
+	static void advance(Iterator_Range<P>& path, size_t n)
+	{
+		path = path.slice(n, path.size());
+	}
+
+	//Matching length of the label and the start of path
+	template <class Range_T>
+	size_t common(Range_T path, Radix_Node const& node) const
+	{
+		index_t const* label = m_labels.begin() + node.label;
+		size_t i = 0;
+		for(; i < node.length && !path.empty() && path.get() == label[i]; ++i)
+		{
+			path.pop();
+		}
+		return i;
+	}
+
+	node_id add_node(node_id parent, size_t label, size_t length)
+	{
+		node_id id = node_id(m_nodes.size());
+		m_nodes.push_back(Radix_Node(parent, label, length));
+
+		Radix_Node& node = m_nodes[id];
+		Radix_Node& above = m_nodes[parent];
+		node.next_sibling = above.first_child;
+		above.first_child = id;
+		m_edges.insert(edge_key(parent, m_labels[label]), id);
+		return id;
+	}
+
+	node_id split(node_id child, size_t at);
+
+private:
+	Vector<Radix_Node> m_nodes;
+	Vector<index_t> m_labels;
+	Hash_Map<uint64_t, node_id> m_edges;
+	size_t m_size;
+};
+
+template <class T, class Index> node_id const Radix_Registry<T, Index>::root;
+template <class T, class Index> node_id const Radix_Registry<T, Index>::missing;
+
+template <class T, class Index>
+template <class Range_T>
+node_id Radix_Registry<T, Index>::get_path(Range_T path)
+{
+	node_id current = root;
+
+	while(!path.empty())
+	{
+		node_id const* child = m_edges.find(edge_key(current, path.get()));
+		if(!child)
+		{
+			//The rest of the path becomes one new node
+			size_t label = m_labels.size();
+			for(; !path.empty(); path.pop())
+			{
+				m_labels.push_back(path.get());
+			}
+			current = add_node(current, label, m_labels.size() - label);
+			break;
+		}
+
+		node_id next = *child;
+		size_t matched = common(path, m_nodes[next]);
+		if(matched < m_nodes[next].length)
+		{
+			next = split(next, matched);
+		}
+
+		advance(path, matched);
+		current = next;
+	}
+
+	Radix_Node& node = m_nodes[current];
+	if(!node.present)
+	{
+		node.present = true;
+		++m_size;
+	}
+
+	return current;
+}
+
+//Cuts the label of child after at indices, the front half becomes a new
+//node in its place.  Returns the new node.
+template <class T, class Index>
+node_id Radix_Registry<T, Index>::split(node_id child, size_t at)
+{
+	node_id parent = m_nodes[child].parent;
+	size_t label = m_nodes[child].label;
+
+	node_id front = node_id(m_nodes.size());
+	m_nodes.push_back(Radix_Node(parent, label, at));
+
+	Radix_Node& node = m_nodes[child];
+	Radix_Node& mid = m_nodes[front];
+	Radix_Node& above = m_nodes[parent];
+
+	//Take over the place of child among its siblings
+	node_id* link = &above.first_child;
+	while(*link != child)
+	{
+		link = &m_nodes[*link].next_sibling;
+	}
+	*link = front;
+	mid.next_sibling = node.next_sibling;
+
+	mid.first_child = child;
+	node.next_sibling = missing;
+	node.parent = front;
+	node.label += uint32_t(at);
+	node.length -= uint32_t(at);
+
+	*m_edges.find(edge_key(parent, m_labels[label])) = front;
+	m_edges.insert(edge_key(front, m_labels[node.label]), child);
+	return front;
+}
+
+}} //namespace
+
+#endif //include guard
@@ -0,0 +1,389 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_RCU_REGISTRY_H
+#define GTL_CONTAINERS_RCU_REGISTRY_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/debug.h>
+#include <gtl/noncopyable.h>
+#include <gtl/scoped.h>
+#include <gtl/containers/vector.h>
+#include <gtl/containers/ilist.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "registry.h"
+
+namespace gtl { namespace registry {
+
+//Node of an Rcu_Registry, never modified once published
+template <class T, class Index> class Rcu_Node : private Noncopyable
+{
+public:
+	typedef Index index_t;
+
+	T const& data() const {return m_data;}
+
+	index_t count() const {return m_count;}
+
+	Rcu_Node const* try_get(index_t index) const
+	{
+		return index < m_count ? children()[index] : NULL;
+	}
+
+	template <class Range_T> Rcu_Node const* try_get_path(Range_T path) const
+	{
+		Rcu_Node const* current = this;
+
+		for(; current && !path.empty(); path.pop())
+		{
+			current = current->try_get(path.get());
+		}
+
+		return current;
+	}
+
+	//Yields Rcu_Node const*, null for missing children
+	Iterator_Range<Rcu_Node* const*> all() const
+	{
+		return Iterator_Range<Rcu_Node* const*>(children(), children() + m_count);
+	}
+
+private:
+	template <class, class> friend class Rcu_Registry;
+
+	Rcu_Node(index_t count, T const& data) : m_data(data), m_count(count) {}
+
+	//The child pointers follow the node in the same block
+	static size_t header_size()
+	{
+		size_t const align = std::alignment_of<Rcu_Node*>::value;
+		return (sizeof(Rcu_Node) + align - 1) & ~(align - 1);
+	}
+
+	static size_t block_size(index_t count)
+	{
+		return header_size() + sizeof(Rcu_Node*) * count;
+	}
+
+	static size_t block_align()
+	{
+		return std::max(std::alignment_of<Rcu_Node>::value, std::alignment_of<Rcu_Node*>::value);
+	}
+
+	Rcu_Node** children()
+	{
+		return reinterpret_cast<Rcu_Node**>(reinterpret_cast<char*>(this) + header_size());
+	}
+
+	Rcu_Node* const* children() const
+	{
+		return reinterpret_cast<Rcu_Node* const*>(reinterpret_cast<char const*>(this) + header_size());
+	}
+
+	T m_data;
+	index_t m_count;
+};
+
+//Registry readable from any number of threads without locking, while
+//writers (serialized by a lock) publish copy on write updates: the nodes
+//along the updated path are copied, and the new root swapped in.
+//
+//Readers go through a per thread Reader, and a Snapshot pins the current
+//tree for as long as it lives.  Replaced nodes are retired with the epoch
+//they were unlinked in, and freed by writers once every pinned reader has
+//entered a later epoch.
+template <class T, class Index = unsigned int> class Rcu_Registry : private Noncopyable
+{
+public:
+	typedef Index index_t;
+	typedef Rcu_Node<T, Index> node_type;
+
+	class Reader;
+	class Snapshot;
+
+	Rcu_Registry(Context const* context) :
+		m_context(context),
+		m_retired(context),
+		m_epoch(1)
+	{
+		m_root.store(create(0, 0), std::memory_order_relaxed);
+	}
+
+	~Rcu_Registry()
+	{
+		GTL_ASSERT(m_readers.empty());
+
+		destroy_tree(m_root.load(std::memory_order_relaxed));
+		for(Retired* retired = m_retired.begin(); retired != m_retired.end(); ++retired)
+		{
+			destroy(retired->node);
+		}
+	}
+
+	//Writer side, copies the path (creating what's missing) and has func
+	//modify the data of the copied target node before publishing it
+	template <class Range_T, class Func_T> void update(Range_T path, Func_T func);
+
+	template <class Range_T> void set(Range_T path, T const& value)
+	{
+		update(path, [&value](T& data){data = value;});
+	}
+
+	//Frees what no reader can see anymore, writers call it after each update
+	void reclaim()
+	{
+		std::lock_guard<std::mutex> lock(m_write_lock);
+		reclaim_locked();
+	}
+
+	size_t retired_count()
+	{
+		std::lock_guard<std::mutex> lock(m_write_lock);
+		return m_retired.size();
+	}
+
+private:
+	struct Retired
+	{
+		node_type* node;
+		uint64_t epoch;
+	};
+
+	//A node with count child slots, taking the data and children of copy_of
+	node_type* create(index_t count, node_type const* copy_of)
+	{
+		size_t size = node_type::block_size(count);
+		void* mem = m_context->allocator->allocate(size, node_type::block_align());
+		auto guard = scope(mem, [this, size](void* p){
+			m_context->allocator->deallocate(p, size, node_type::block_align());});
+
+		node_type* node = new (mem) node_type(count, copy_of ? copy_of->m_data : T());
+		guard.release();
+
+		node_type** children = node->children();
+		index_t copied = 0;
+		if(copy_of)
+		{
+			copied = std::min(copy_of->m_count, count);
+			std::copy(copy_of->children(), copy_of->children() + copied, children);
+		}
+		std::fill(children + copied, children + count, static_cast<node_type*>(0));
+		return node;
+	}
+
+	void destroy(node_type* node)
+	{
+		size_t size = node_type::block_size(node->m_count);
+		destruct(node);
+		m_context->allocator->deallocate(node, size, node_type::block_align());
+	}
+
+	void destroy_tree(node_type* node)
+	{
+		for(index_t i = 0; i < node->m_count; ++i)
+		{
+			if(node_type* child = node->children()[i])
+			{
+				destroy_tree(child);
+			}
+		}
+		destroy(node);
+	}
+
+	void reclaim_locked();
+
+private:
+	Context const* m_context;
+	std::atomic<node_type*> m_root;
+	std::mutex m_write_lock;
+	Vector<Retired> m_retired;
+	std::atomic<uint64_t> m_epoch;
+	std::mutex m_reader_lock;
+	Ilist<Reader> m_readers;
+};
+
+//Registers a reading thread, not to be shared between threads
+template <class T, class Index>
+class Rcu_Registry<T, Index>::Reader : public Ilist_Node, private Noncopyable
+{
+public:
+	Reader(Rcu_Registry& registry) : m_registry(registry), m_pinned(0), m_depth(0)
+	{
+		std::lock_guard<std::mutex> lock(m_registry.m_reader_lock);
+		m_registry.m_readers.push_back(*this);
+	}
+
+	~Reader()
+	{
+		GTL_ASSERT(m_depth == 0);
+		std::lock_guard<std::mutex> lock(m_registry.m_reader_lock);
+		m_registry.m_readers.erase(*this);
+	}
+
+private:
+	friend class Rcu_Registry;
+	friend class Snapshot;
+
+	node_type const* pin()
+	{
+		if(m_depth++ == 0)
+		{
+			//Sequentially consistent with the writer publishing the root and
+			//then scanning, either it sees this epoch or we see its root
+			m_pinned.store(m_registry.m_epoch.load());
+		}
+
+		return m_registry.m_root.load();
+	}
+
+	void unpin()
+	{
+		if(--m_depth == 0)
+		{
+			m_pinned.store(0, std::memory_order_release);
+		}
+	}
+
+	Rcu_Registry& m_registry;
+	std::atomic<uint64_t> m_pinned;
+	size_t m_depth;
+};
+
+//Keeps the tree current at construction alive, lookups through it are
+//stable no matter what writers do meanwhile
+template <class T, class Index>
+class Rcu_Registry<T, Index>::Snapshot : private Noncopyable
+{
+public:
+	Snapshot(Reader& reader) : m_reader(reader), m_root(reader.pin()) {}
+
+	~Snapshot()
+	{
+		m_reader.unpin();
+	}
+
+	node_type const* root() const {return m_root;}
+
+	template <class Range_T> node_type const* try_get_path(Range_T path) const
+	{
+		return m_root->try_get_path(path);
+	}
+
+private:
+	Reader& m_reader;
+	node_type const* m_root;
+};
+
+template <class T, class Index>
+template <class Range_T, class Func_T>
+void Rcu_Registry<T, Index>::update(Range_T path, Func_T func)
+{
+	std::lock_guard<std::mutex> lock(m_write_lock);
+
+	//The nodes along path as they are now, null where missing
+	Vector<node_type*> old_nodes(m_context);
+	Vector<index_t> indices(m_context);
+	node_type* current = m_root.load(std::memory_order_relaxed);
+	old_nodes.push_back(current);
+	for(; !path.empty(); path.pop())
+	{
+		index_t index = path.get();
+		indices.push_back(index);
+		current = current ? const_cast<node_type*>(current->try_get(index)) : 0;
+		old_nodes.push_back(current);
+	}
+
+	//Copies bottom up, only the copies are freed if anything throws
+	Vector<node_type*> copies(m_context);
+	copies.reserve(old_nodes.size());
+	auto guard = scope(&copies, [this](Vector<node_type*>* nodes){
+		for(node_type** node = nodes->begin(); node != nodes->end(); ++node) destroy(*node);});
+
+	node_type* leaf = old_nodes.back();
+	node_type* copy = create(leaf ? leaf->m_count : 0, leaf);
+	copies.push_back(copy);
+	func(copy->m_data);
+
+	for(size_t level = indices.size(); level-- > 0; )
+	{
+		node_type* old = old_nodes[level];
+		index_t index = indices[level];
+		index_t count = old ? std::max(old->m_count, index_t(index + 1)) : index_t(index + 1);
+
+		node_type* parent = create(count, old);
+		copies.push_back(parent);
+		parent->children()[index] = copy;
+		copy = parent;
+	}
+
+	m_retired.reserve(m_retired.size() + old_nodes.size());
+	guard.release();
+
+	m_root.store(copy);
+
+	uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+	for(node_type** old = old_nodes.begin(); old != old_nodes.end(); ++old)
+	{
+		if(*old)
+		{
+			Retired retired = {*old, epoch};
+			m_retired.push_back(retired);
+		}
+	}
+	m_epoch.store(epoch + 1);
+
+	reclaim_locked();
+}
+
+template <class T, class Index>
+void Rcu_Registry<T, Index>::reclaim_locked()
+{
+	//Oldest epoch any reader might still be looking at
+	uint64_t oldest = m_epoch.load();
+	{
+		std::lock_guard<std::mutex> lock(m_reader_lock);
+		for(typename Ilist<Reader>::range readers = m_readers.all(); !readers.empty(); readers.pop())
+		{
+			uint64_t pinned = readers.ref().m_pinned.load();
+			if(pinned != 0 && pinned < oldest)
+			{
+				oldest = pinned;
+			}
+		}
+	}
+
+	Retired* kept = m_retired.begin();
+	for(Retired* retired = m_retired.begin(); retired != m_retired.end(); ++retired)
+	{
+		if(retired->epoch < oldest)
+		{
+			destroy(retired->node);
+		}
+		else
+		{
+			*kept++ = *retired;
+		}
+	}
+	m_retired.erase(kept, m_retired.end());
+}
+
+}} //namespace
+
+#endif //include guard
@@ -18,16 +18,19 @@
 #define GTL_CONTAINERS_REGISTRY_H
 
 #include <gtl/common.h>
-#include <gtl/containers/vector.h>
+#include <gtl/containers/small_vector.h>
 #include <gtl/range.h>
 
 namespace gtl { namespace registry {
 
+//Handle to a node of the array based registries (Dense_Registry & etc)
+typedef uint32_t node_id;
+
 template <class T, class Index = unsigned int> class Node
 {
 public:
 	typedef Index index_t;
-	typedef Vector<Node*> Child_Array;
+	typedef Small_Vector<Node*, 4> Child_Array;
 	//Yields Node*
 	typedef typename Child_Array::const_range range;
 
@@ -0,0 +1,252 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_REGISTRY_IMAGE_H
+#define GTL_CONTAINERS_REGISTRY_IMAGE_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/type_traits.h>
+#include <gtl/containers/vector.h>
+#include <gtl/range.h>
+#include <algorithm>
+#include <cstring>
+#include "registry.h"
+
+namespace gtl { namespace registry {
+
+//A registry frozen into one block, read back in place (from a mapped file
+//for instance) without any parsing.  All references are offsets and ids,
+//so the block may sit at any address.  Laid out as:
+//
+//  Image_Header
+//  Image_Node[node_count]    nodes in breadth first order, root first
+//  node_id[slot_count]       child slots, image_missing for absent ones
+//  T[node_count]             at data_offset, aligned for T
+struct Image_Header
+{
+	static uint32_t const magic_value = 0x47524749; //"IGRG"
+	static uint32_t const current_version = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t data_size;
+	uint32_t index_size;
+	uint32_t node_count;
+	uint32_t slot_count;
+	uint32_t data_offset;
+	uint32_t total_size;
+};
+
+struct Image_Node
+{
+	uint32_t first_slot;
+	uint32_t count;
+};
+
+static node_id const image_missing = node_id(-1);
+
+//Appends the image of the tree under root to image, context is only used
+//for scratch tables.  T is copied bitwise.  The image starts padded to the
+//alignment Image_View::open needs, its offset is returned.
+template <class T, class Index>
+size_t freeze(Context const* context, Node<T, Index> const& root, Vector<char>& image)
+{
+	static_assert(std::has_trivial_copy_constructor<T>::value, "image data is copied bitwise");
+
+	Vector<Node<T, Index> const*> order(context);
+	Vector<Image_Node> nodes(context);
+	Vector<node_id> slots(context);
+
+	//Children get their ids as they are queued
+	order.push_back(&root);
+	for(size_t i = 0; i < order.size(); ++i)
+	{
+		typename Node<T, Index>::range children = order[i]->children();
+
+		Image_Node node = {uint32_t(slots.size()), 0};
+		size_t used = 0;
+		for(size_t slot = 0; !children.empty(); children.pop(), ++slot)
+		{
+			Node<T, Index> const* child = children.get();
+			if(child)
+			{
+				slots.push_back(node_id(order.size()));
+				order.push_back(child);
+				used = slot + 1;
+			}
+			else
+			{
+				slots.push_back(image_missing);
+			}
+		}
+
+		//Trailing empty slots are left out
+		slots.resize(node.first_slot + used);
+		node.count = uint32_t(used);
+		nodes.push_back(node);
+	}
+
+	size_t const align = std::alignment_of<T>::value;
+	size_t tables = sizeof(Image_Header) + sizeof(Image_Node) * nodes.size() + sizeof(node_id) * slots.size();
+	size_t data_offset = (tables + align - 1) & ~(align - 1);
+
+	Image_Header header;
+	header.magic = Image_Header::magic_value;
+	header.version = Image_Header::current_version;
+	header.data_size = uint32_t(sizeof(T));
+	header.index_size = uint32_t(sizeof(Index));
+	header.node_count = uint32_t(nodes.size());
+	header.slot_count = uint32_t(slots.size());
+	header.data_offset = uint32_t(data_offset);
+	header.total_size = uint32_t(data_offset + sizeof(T) * nodes.size());
+
+	size_t const image_align = std::max(align, std::alignment_of<Image_Header>::value);
+	size_t base = (image.size() + image_align - 1) & ~(image_align - 1);
+	image.resize(base + header.total_size, 0);
+	char* out = image.begin() + base;
+
+	std::memcpy(out, &header, sizeof(header));
+	std::memcpy(out + sizeof(header), nodes.begin(), sizeof(Image_Node) * nodes.size());
+	std::memcpy(out + sizeof(header) + sizeof(Image_Node) * nodes.size(), slots.begin(), sizeof(node_id) * slots.size());
+	for(size_t i = 0; i < order.size(); ++i)
+	{
+		std::memcpy(out + data_offset + sizeof(T) * i, &order[i]->data(), sizeof(T));
+	}
+	return base;
+}
+
+//Read only registry over an image from freeze.  The image must stay put
+//and be aligned for both T and the 32-bit tables, as mapped memory is.
+template <class T, class Index = unsigned int> class Image_View
+{
+public:
+	typedef Index index_t;
+	//Yields the node_id of each child slot, image_missing for empty ones
+	typedef Iterator_Range<node_id const*> range;
+
+	static node_id const root = 0;
+	static node_id const missing = image_missing;
+
+	Image_View() : m_nodes(0), m_slots(0), m_data(0), m_node_count(0), m_slot_count(0) {}
+
+	//Checks the header and the table bounds, not the tables themselves
+	bool open(void const* image, size_t size)
+	{
+		size_t const align = std::max(std::alignment_of<T>::value, std::alignment_of<Image_Header>::value);
+
+		Image_Header header;
+		if(!image || size < sizeof(header) || reinterpret_cast<uintptr_t>(image) % align)
+		{
+			return false;
+		}
+		std::memcpy(&header, image, sizeof(header));
+
+		size_t tables = sizeof(header) + sizeof(Image_Node) * size_t(header.node_count) +
+			sizeof(node_id) * size_t(header.slot_count);
+
+		if(header.magic != Image_Header::magic_value ||
+			header.version != Image_Header::current_version ||
+			header.data_size != sizeof(T) ||
+			header.index_size != sizeof(Index) ||
+			header.node_count == 0 ||
+			header.data_offset < tables ||
+			header.data_offset % std::alignment_of<T>::value ||
+			header.total_size > size ||
+			header.total_size < header.data_offset + sizeof(T) * size_t(header.node_count))
+		{
+			return false;
+		}
+
+		char const* base = static_cast<char const*>(image);
+		m_nodes = reinterpret_cast<Image_Node const*>(base + sizeof(header));
+		m_slots = reinterpret_cast<node_id const*>(m_nodes + header.node_count);
+		m_data = reinterpret_cast<T const*>(base + header.data_offset);
+		m_node_count = header.node_count;
+		m_slot_count = header.slot_count;
+		return true;
+	}
+
+	//Walks every node, for images that can't be trusted
+	bool verify() const
+	{
+		for(size_t i = 0; i < m_node_count; ++i)
+		{
+			Image_Node const& node = m_nodes[i];
+			if(node.first_slot > m_slot_count || node.count > m_slot_count - node.first_slot)
+			{
+				return false;
+			}
+
+			for(node_id const* slot = m_slots + node.first_slot; slot != m_slots + node.first_slot + node.count; ++slot)
+			{
+				//Breadth first, children always come later
+				if(*slot != missing && (*slot >= m_node_count || *slot <= i))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool is_open() const {return m_nodes != 0;}
+
+	size_t size() const {return m_node_count;}
+
+	T const& data(node_id node) const {return m_data[node];}
+
+	index_t count(node_id node) const {return index_t(m_nodes[node].count);}
+
+	node_id try_get(node_id parent, index_t index) const
+	{
+		Image_Node const& node = m_nodes[parent];
+		return index < node.count ? m_slots[node.first_slot + index] : missing;
+	}
+
+	template <class Range_T> node_id try_get_path(Range_T path, node_id from = root) const
+	{
+		node_id current = from;
+
+		for(; current != missing && !path.empty(); path.pop())
+		{
+			current = try_get(current, path.get());
+		}
+
+		return current;
+	}
+
+	range children(node_id node) const
+	{
+		node_id const* first = m_slots + m_nodes[node].first_slot;
+		return range(first, first + m_nodes[node].count);
+	}
+
+private:
+	Image_Node const* m_nodes;
+	node_id const* m_slots;
+	T const* m_data;
+	size_t m_node_count;
+	size_t m_slot_count;
+};
+
+template <class T, class Index> node_id const Image_View<T, Index>::root;
+template <class T, class Index> node_id const Image_View<T, Index>::missing;
+
+}} //namespace
+
+#endif //include guard
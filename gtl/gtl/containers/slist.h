@@ -0,0 +1,318 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_SLIST_H
+#define GTL_CONTAINERS_SLIST_H
+
+#include <gtl/common.h>
+#include <gtl/debug.h>
+#include <iterator>
+#include <atomic>
+
+namespace gtl {
+
+//One pointer hook, for elements that are only pushed and popped at the ends.
+//The link is atomic so Atomic_Slist can read it while another thread
+//relinks the node, Slist itself only uses relaxed (plain) accesses.
+template <class Tag> struct Slist_Node_T
+{
+	Slist_Node_T() {}
+
+	Slist_Node_T* get_next() const {return next.load(std::memory_order_relaxed);}
+	void set_next(Slist_Node_T* node) {next.store(node, std::memory_order_relaxed);}
+
+	std::atomic<Slist_Node_T*> next;
+
+//noncopyable
+private:
+	Slist_Node_T(Slist_Node_T const&);
+	Slist_Node_T& operator=(Slist_Node_T const&);
+};
+
+typedef Slist_Node_T<void> Slist_Node;
+
+template <class T, class Tag, class Ref, class Ptr> struct Slist_Iterator
+{
+	typedef Slist_Iterator<T, Tag, T&, T*> iterator;
+	typedef Slist_Iterator<T, Tag, T const&, T const*> const_iterator;
+	typedef Slist_Iterator<T, Tag, Ref, Ptr> self;
+
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef std::forward_iterator_tag iterator_category;
+
+	typedef T value_type;
+	typedef Ptr pointer;
+	typedef Ref reference;
+	typedef Slist_Node_T<Tag> node_t;
+
+	Slist_Iterator() : m_node(0) {}
+	Slist_Iterator(node_t* x) : m_node(x) {}
+	Slist_Iterator(iterator const& iter) : m_node(iter.m_node) {}
+
+	reference operator*() const
+	{
+		return *static_cast<pointer>(m_node);
+	}
+
+	pointer operator->() const {return &(operator*());}
+
+	self& operator++()
+	{
+		m_node = m_node->get_next();
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self temp = *this;
+		m_node = m_node->get_next();
+		return temp;
+	}
+
+	bool operator==(self const& other) const
+	{
+		return m_node == other.m_node;
+	}
+
+	bool operator!=(self const& other) const
+	{
+		return m_node != other.m_node;
+	}
+
+	node_t* m_node;
+};
+
+template <class T, class Tag, class Access> class Slist_Range
+{
+public:
+	typedef Access* Ptr;
+	typedef Access& ref_type;
+
+	typedef T const& get_type;
+	typedef T const& set_type;
+	typedef Slist_Node_T<Tag> node_type;
+
+	Slist_Range(node_type* begin) : m_node(begin) {}
+
+	template <class Ptr>
+	Slist_Range(Slist_Range<T, Tag, Ptr> const& other) : m_node(other.m_node)
+	{
+	}
+
+	ref_type ref() const {return *current_ptr();}
+	get_type get() const {return *current_ptr();}
+	void set(set_type value) const {*current_ptr() = value;}
+
+	void pop()
+	{
+		m_node = m_node->get_next();
+	}
+
+	bool empty() const {return m_node == 0;}
+
+	node_type* m_node;
+
+private:
+	Ptr current_ptr() const
+	{
+		return static_cast<Ptr>(m_node);
+	}
+};
+
+//Intrusive singly linked list.  Keeps the tail as well, so whole lists
+//splice onto either end in constant time.
+template <class T, class Tag = void> class Slist
+{
+public:
+	typedef Slist_Node_T<Tag> node_t;
+	typedef T value_type;
+	typedef value_type* pointer;
+	typedef const value_type* const_pointer;
+	typedef value_type& reference;
+	typedef const value_type& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	typedef Slist_Iterator<T, Tag, T&, T*> iterator;
+	typedef Slist_Iterator<T, Tag, T const&, T const*> const_iterator;
+
+	typedef Slist_Range<T, Tag, T> range;
+	typedef Slist_Range<T, Tag, T const> const_range;
+
+	Slist() : m_head(0), m_tail(0), m_size(0) {}
+
+	iterator begin() {return m_head;}
+	//A const cast is implied
+	const_iterator begin() const {return m_head;}
+
+	iterator end() {return iterator();}
+	const_iterator end() const {return const_iterator();}
+
+	range all()
+	{
+		return range(m_head);
+	}
+
+	const_range all() const
+	{
+		return const_range(m_head);
+	}
+
+	bool empty() const { return m_head == 0; }
+
+	size_type size() const {return m_size;}
+
+	size_type max_size() const { return size_type(-1); }
+
+	reference front() { return *begin(); }
+	const_reference front() const { return *begin(); }
+	reference back() { return *static_cast<pointer>(m_tail); }
+	const_reference back() const { return *static_cast<const_pointer>(m_tail); }
+
+	iterator get_iterator(T& x)
+	{
+		return iterator(static_cast<node_t*>(&x));
+	}
+
+	void swap(Slist& x)
+	{
+		std::swap(m_head, x.m_head);
+		std::swap(m_tail, x.m_tail);
+		std::swap(m_size, x.m_size);
+	}
+
+	void push_front(T& x)
+	{
+		node_t* node = &x;
+		node->set_next(m_head);
+		if(!m_head)
+		{
+			m_tail = node;
+		}
+		m_head = node;
+		++m_size;
+	}
+
+	void push_back(T& x)
+	{
+		node_t* node = &x;
+		node->set_next(0);
+		if(m_tail)
+		{
+			m_tail->set_next(node);
+		}
+		else
+		{
+			m_head = node;
+		}
+		m_tail = node;
+		++m_size;
+	}
+
+	iterator insert_after(iterator position, T& x)
+	{
+		node_t* node = &x;
+		node->set_next(position.m_node->get_next());
+		position.m_node->set_next(node);
+		if(m_tail == position.m_node)
+		{
+			m_tail = node;
+		}
+		++m_size;
+		return node;
+	}
+
+	void pop_front()
+	{
+		GTL_ASSERT(!empty());
+		m_head = m_head->get_next();
+		if(!m_head)
+		{
+			m_tail = 0;
+		}
+		--m_size;
+	}
+
+	//Returns the element following the erased one
+	iterator erase_after(iterator position)
+	{
+		node_t* node = position.m_node->get_next();
+		position.m_node->set_next(node->get_next());
+		if(m_tail == node)
+		{
+			m_tail = position.m_node;
+		}
+		--m_size;
+		return node->get_next();
+	}
+
+	void clear()
+	{
+		m_head = 0;
+		m_tail = 0;
+		m_size = 0;
+	}
+
+	//Moves all of x in front of this list
+	void splice_front(Slist& x)
+	{
+		if(!x.empty())
+		{
+			x.m_tail->set_next(m_head);
+			if(!m_head)
+			{
+				m_tail = x.m_tail;
+			}
+			m_head = x.m_head;
+			m_size += x.m_size;
+			x.clear();
+		}
+	}
+
+	//Moves all of x behind this list
+	void splice_back(Slist& x)
+	{
+		if(!x.empty())
+		{
+			if(m_tail)
+			{
+				m_tail->set_next(x.m_head);
+			}
+			else
+			{
+				m_head = x.m_head;
+			}
+			m_tail = x.m_tail;
+			m_size += x.m_size;
+			x.clear();
+		}
+	}
+
+private:
+	Slist(Slist const&);
+	Slist& operator=(Slist const&);
+
+private:
+	node_t* m_head;
+	node_t* m_tail;
+	size_type m_size;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_CONTAINERS_SMALL_VECTOR_H
+#define GTL_CONTAINERS_SMALL_VECTOR_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <type_traits>
+#include "vector.h"
+
+namespace gtl {
+
+//Starts out on an inline buffer of N elements, spills to the context
+//allocator once it grows past that
+template <class T, size_t N> struct Small_Vector_Storage : public Vector_Storage<T>
+{
+	Small_Vector_Storage(Context const* context) :
+		Vector_Storage<T>(context)
+	{
+		reset();
+	}
+
+	Small_Vector_Storage(Context const* context, size_t n) :
+		Vector_Storage<T>(context)
+	{
+		if(n <= N)
+		{
+			reset();
+		}
+		else
+		{
+			this->m_start = this->allocate(n);
+			this->m_finish = this->m_start;
+			this->m_end = this->m_start + n;
+		}
+	}
+
+	~Small_Vector_Storage()
+	{
+		//Nothing for the base to release
+		if(is_inline())
+		{
+			Vector_Storage<T>::reset();
+		}
+	}
+
+	void deallocate(T* data, size_t n)
+	{
+		if(data != buffer())
+		{
+			Vector_Storage<T>::deallocate(data, n);
+		}
+	}
+
+	bool expand(size_t n)
+	{
+		return !is_inline() && Vector_Storage<T>::expand(n);
+	}
+
+	bool is_inline() const
+	{
+		return this->m_start == buffer();
+	}
+
+	void reset()
+	{
+		this->m_start = this->m_finish = buffer();
+		this->m_end = buffer() + N;
+	}
+
+	T* buffer()
+	{
+		return reinterpret_cast<T*>(&m_buffer);
+	}
+
+	T const* buffer() const
+	{
+		return reinterpret_cast<T const*>(&m_buffer);
+	}
+
+	typename std::aligned_storage<sizeof(T) * N, std::alignment_of<T>::value>::type m_buffer;
+};
+
+//Vector holding up to N elements without allocating.  Moves and swaps of
+//inline contents move the elements one by one.
+template <class T, size_t N> class Small_Vector : public Vector<T, Small_Vector_Storage<T, N> >
+{
+	typedef Vector<T, Small_Vector_Storage<T, N> > base_type;
+
+public:
+	static size_t const inline_capacity = N;
+
+	Small_Vector(Context const* context) : base_type(context)
+	{
+	}
+
+	Small_Vector(Context const* context, size_t count) : base_type(context, count)
+	{
+	}
+
+	Small_Vector(Context const* context, size_t count, Empty_Storage_Tag const& tag) :
+		base_type(context, count, tag)
+	{
+	}
+
+	Small_Vector(Small_Vector const& other) : base_type(other)
+	{
+	}
+
+	Small_Vector(Small_Vector&& other) GTL_NOTHROW : base_type(std::move(other))
+	{
+	}
+
+	Small_Vector& operator=(Small_Vector const& x)
+	{
+		base_type::operator=(x);
+		return *this;
+	}
+
+	Small_Vector& operator=(Small_Vector&& x) GTL_NOTHROW
+	{
+		base_type::operator=(std::move(x));
+		return *this;
+	}
+};
+
+} //namespace
+
+#endif
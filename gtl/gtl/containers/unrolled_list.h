@@ -0,0 +1,675 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_CONTAINERS_UNROLLED_LIST_H
+#define GTL_CONTAINERS_UNROLLED_LIST_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/debug.h>
+#include <gtl/scoped.h>
+#include <gtl/type_traits.h>
+#include <algorithm>
+#include <iterator>
+#include "construct.h"
+#include "emplace.h"
+#include "list_base.h"
+
+namespace gtl {
+
+//Holds up to K elements packed at the front, never empty while linked
+template <class T, size_t K> struct Unrolled_Node_T : public List_Node_Base
+{
+	size_t count;
+	typename std::aligned_storage<
+		sizeof(T) * K,
+		std::alignment_of<T>::value
+	>::type data;
+
+	T* begin() {return reinterpret_cast<T*>(&data);}
+	T* end() {return begin() + count;}
+};
+
+template <class T, size_t K, class Ref, class Ptr>
+	struct Unrolled_Iterator
+{
+	typedef Unrolled_Iterator<T, K, T&, T*> iterator;
+	typedef Unrolled_Iterator<T, K, T const&, T const*> const_iterator;
+	typedef Unrolled_Iterator<T, K, Ref, Ptr> self;
+
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef std::bidirectional_iterator_tag iterator_category;
+
+	typedef T value_type;
+	typedef Ptr pointer;
+	typedef Ref reference;
+	typedef Unrolled_Node_T<T, K> node_type;
+
+	Unrolled_Iterator() : m_node(0), m_index(0) {}
+	Unrolled_Iterator(List_Node_Base* node, size_t index) : m_node(node), m_index(index) {}
+	Unrolled_Iterator(iterator const& iter) : m_node(iter.m_node), m_index(iter.m_index) {}
+
+	reference operator*() const
+	{
+		return static_cast<node_type*>(m_node)->begin()[m_index];
+	}
+
+	pointer operator->() const {return &(operator*());}
+
+	self& operator++()
+	{
+		if(++m_index == static_cast<node_type*>(m_node)->count)
+		{
+			m_node = m_node->next;
+			m_index = 0;
+		}
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self temp = *this;
+		++*this;
+		return temp;
+	}
+
+	self& operator--()
+	{
+		if(m_index == 0)
+		{
+			m_node = m_node->prev;
+			m_index = static_cast<node_type*>(m_node)->count;
+		}
+		--m_index;
+		return *this;
+	}
+
+	self operator--(int)
+	{
+		self temp = *this;
+		--*this;
+		return temp;
+	}
+
+	bool operator==(self const& other) const
+	{
+		return m_node == other.m_node && m_index == other.m_index;
+	}
+
+	bool operator!=(self const& other) const
+	{
+		return !(*this == other);
+	}
+
+	List_Node_Base* m_node;
+	size_t m_index;
+};
+
+//Steps through the elements of a node with a plain pointer, only touching
+//the links once per node
+template <class T, size_t K, class Access> class Unrolled_Forward_Range
+{
+public:
+	typedef Access* Ptr;
+	typedef Access& ref_type;
+
+	typedef T const& get_type;
+	typedef T const& set_type;
+	typedef Unrolled_Node_T<T, K> node_type;
+
+	Unrolled_Forward_Range(List_Node_Base* begin, List_Node_Base* end) : m_node(begin), m_end(end)
+	{
+		load();
+	}
+
+	template <class Other>
+	Unrolled_Forward_Range(Unrolled_Forward_Range<T, K, Other> const& other) :
+		m_node(other.m_node), m_end(other.m_end), m_cur(other.m_cur), m_last(other.m_last)
+	{
+	}
+
+	ref_type ref() const {return *m_cur;}
+	get_type get() const {return *m_cur;}
+	void set(set_type value) const {*m_cur = value;}
+
+	void pop()
+	{
+		if(++m_cur == m_last)
+		{
+			m_node = m_node->next;
+			load();
+		}
+	}
+
+	bool empty() const {return m_cur == m_last;}
+
+private:
+	template <class, size_t, class> friend class Unrolled_Forward_Range;
+
+	void load()
+	{
+		if(m_node != m_end)
+		{
+			node_type* node = static_cast<node_type*>(m_node);
+			m_cur = node->begin();
+			m_last = node->end();
+		}
+		else
+		{
+			m_cur = m_last = 0;
+		}
+	}
+
+	List_Node_Base* m_node;
+	List_Node_Base* m_end;
+	Ptr m_cur;
+	Ptr m_last;
+};
+
+template <class T, size_t K, class Access> class Unrolled_Reverse_Range
+{
+public:
+	typedef Access* Ptr;
+	typedef Access& ref_type;
+
+	typedef T const& get_type;
+	typedef T const& set_type;
+	typedef Unrolled_Node_T<T, K> node_type;
+
+	Unrolled_Reverse_Range(List_Node_Base* begin, List_Node_Base* end) : m_node(end->prev), m_begin(begin->prev)
+	{
+		load();
+	}
+
+	template <class Other>
+	Unrolled_Reverse_Range(Unrolled_Reverse_Range<T, K, Other> const& other) :
+		m_node(other.m_node), m_begin(other.m_begin), m_first(other.m_first), m_cur(other.m_cur)
+	{
+	}
+
+	ref_type ref() const {return m_cur[-1];}
+	get_type get() const {return m_cur[-1];}
+	void set(set_type value) const {m_cur[-1] = value;}
+
+	void pop()
+	{
+		if(--m_cur == m_first)
+		{
+			m_node = m_node->prev;
+			load();
+		}
+	}
+
+	bool empty() const {return m_cur == m_first;}
+
+private:
+	template <class, size_t, class> friend class Unrolled_Reverse_Range;
+
+	void load()
+	{
+		if(m_node != m_begin)
+		{
+			node_type* node = static_cast<node_type*>(m_node);
+			m_first = node->begin();
+			m_cur = node->end();
+		}
+		else
+		{
+			m_first = m_cur = 0;
+		}
+	}
+
+	List_Node_Base* m_node;
+	List_Node_Base* m_begin;
+	Ptr m_first;
+	Ptr m_cur;
+};
+
+//Each node's elements as an Iterator_Range, for loops that want plain
+//pointers in the inner step
+template <class T, size_t K, class Access> class Unrolled_Segment_Range : public List_Forward_Range_Base
+{
+public:
+	typedef Iterator_Range<Access*> get_type;
+	typedef Unrolled_Node_T<T, K> node_type;
+
+	Unrolled_Segment_Range(List_Node_Base* begin, List_Node_Base* end) : List_Forward_Range_Base(begin, end) {}
+
+	template <class Other>
+	Unrolled_Segment_Range(Unrolled_Segment_Range<T, K, Other> const& other) : List_Forward_Range_Base(other)
+	{
+	}
+
+	get_type get() const
+	{
+		node_type* node = static_cast<node_type*>(current());
+		return get_type(node->begin(), node->end());
+	}
+};
+
+//List keeping K elements per node, so traversal mostly walks contiguous
+//memory.  Inserting into a full node splits it in half, and nodes are freed
+//once emptied.  Insert and erase invalidate iterators into the affected
+//node (and the one split off), splices move whole nodes.
+template <class T, size_t K = 16> class Unrolled_List
+{
+	static_assert(K >= 2, "full nodes are split in half");
+
+public:
+	typedef Unrolled_Node_T<T, K> node_type;
+
+	typedef T value_type;
+	typedef value_type* pointer;
+	typedef const value_type* const_pointer;
+	typedef value_type& reference;
+	typedef const value_type& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	typedef Unrolled_Iterator<T, K, T&, T*> iterator;
+	typedef Unrolled_Iterator<T, K, T const&, T const*> const_iterator;
+
+	typedef Unrolled_Forward_Range<T, K, T> range;
+	typedef Unrolled_Forward_Range<T, K, T const> const_range;
+
+	typedef Unrolled_Reverse_Range<T, K, T> reverse_range;
+	typedef Unrolled_Reverse_Range<T, K, T const> const_reverse_range;
+
+	typedef Unrolled_Segment_Range<T, K, T> segment_range;
+	typedef Unrolled_Segment_Range<T, K, T const> const_segment_range;
+
+	static size_t const node_capacity = K;
+
+	Unrolled_List(Context const* context) : m_context(context), m_size(0)
+	{
+		m_node.next = &m_node;
+		m_node.prev = &m_node;
+	}
+
+	~Unrolled_List()
+	{
+		clear();
+	}
+
+	iterator begin() {return iterator(m_node.next, 0);}
+	//A const cast is implied
+	const_iterator begin() const {return iterator(m_node.next, 0);}
+
+	iterator end() {return iterator(&m_node, 0);}
+	const_iterator end() const {return iterator(const_cast<List_Node_Base*>(&m_node), 0);}
+
+	range all()
+	{
+		return range(m_node.next, &m_node);
+	}
+
+	const_range all() const
+	{
+		return const_range(m_node.next, const_cast<List_Node_Base*>(&m_node));
+	}
+
+	reverse_range reverse()
+	{
+		return reverse_range(m_node.next, &m_node);
+	}
+
+	const_reverse_range reverse() const
+	{
+		return const_reverse_range(m_node.next, const_cast<List_Node_Base*>(&m_node));
+	}
+
+	segment_range segments()
+	{
+		return segment_range(m_node.next, &m_node);
+	}
+
+	const_segment_range segments() const
+	{
+		return const_segment_range(m_node.next, const_cast<List_Node_Base*>(&m_node));
+	}
+
+	bool empty() const { return m_node.next == &m_node; }
+
+	size_type size() const {return m_size;}
+
+	size_type max_size() const { return size_type(-1); }
+
+	reference front() { return *head()->begin(); }
+	const_reference front() const { return *head()->begin(); }
+	reference back() { return tail()->end()[-1]; }
+	const_reference back() const { return tail()->end()[-1]; }
+
+	void swap(Unrolled_List& x)
+	{
+		std::swap(m_context, x.m_context);
+		swap_chains(m_node, x.m_node);
+		std::swap(m_size, x.m_size);
+	}
+
+	iterator insert(iterator position, T const& x)
+	{
+		return func_emplace(position, gtl::emplace(x));
+	}
+
+	iterator insert(iterator position, T&& x)
+	{
+		return func_emplace(position, gtl::emplace(std::move(x)));
+	}
+
+	template <class TT>
+	iterator emplace(iterator position, TT&& x)
+	{
+		return func_emplace(position, gtl::emplace(std::forward<TT>(x)));
+	}
+
+	template <class Emplace_T>
+	iterator func_emplace(iterator position, Emplace_T func);
+
+	template <class Range_T>
+	void insert_range(iterator position, Range_T range)
+	{
+		for(; !range.empty(); range.pop())
+		{
+			position = insert(position, range.get());
+			++position;
+		}
+	}
+
+	void push_front(T const& x) {func_emplace(begin(), gtl::emplace(x));}
+	void push_back(T const& x) {func_emplace_back(gtl::emplace(x));}
+
+	template <class TT>
+	void emplace_front(TT&& x) {func_emplace(begin(), gtl::emplace(std::forward<TT>(x)));}
+
+	template <class TT>
+	void emplace_back(TT&& x) {func_emplace_back(gtl::emplace(std::forward<TT>(x)));}
+
+	template <class Emplace_T>
+	void func_emplace_front(Emplace_T func) {func_emplace(begin(), func);}
+
+	template <class Emplace_T>
+	void func_emplace_back(Emplace_T func)
+	{
+		node_type* node = tail();
+		if(empty() || node->count == K)
+		{
+			node = create_node(&m_node);
+			auto guard = scope(node, [this](node_type* p){this->remove_node(p);});
+			func(node->end());
+			guard.release();
+		}
+		else
+		{
+			func(node->end());
+		}
+
+		++node->count;
+		++m_size;
+	}
+
+	iterator erase(iterator position);
+
+	void pop_front() {erase(begin());}
+
+	void pop_back()
+	{
+		node_type* node = tail();
+		destruct(node->end() - 1);
+		--m_size;
+		if(--node->count == 0)
+		{
+			remove_node(node);
+		}
+	}
+
+	void clear();
+
+	//Splitting the node at position is bounded by K, the rest relinks nodes
+	void splice(iterator position, Unrolled_List& x)
+	{
+		verify_transferrable(x);
+		if (!x.empty())
+		{
+			transfer(split(position), x.m_node.next, &x.m_node);
+			m_size += x.m_size;
+			x.m_size = 0;
+		}
+	}
+
+	//Counts [first, last) a node at a time when moving between lists
+	void splice(iterator position, Unrolled_List& x, iterator first, iterator last)
+	{
+		verify_transferrable(x);
+		if (first == last)
+		{
+			return;
+		}
+
+		//Each split moves the later part of a node, so positions past it in
+		//the same node are rebased, and last is split before first
+		List_Node_Base* target = split(position);
+		rebase(first, position, target);
+		rebase(last, position, target);
+
+		List_Node_Base* last_node = split(last);
+		List_Node_Base* first_node = split(first);
+
+		if(&x != this)
+		{
+			size_type count = 0;
+			for(List_Node_Base* node = first_node; node != last_node; node = node->next)
+			{
+				count += static_cast<node_type*>(node)->count;
+			}
+			m_size += count;
+			x.m_size -= count;
+		}
+
+		transfer(target, first_node, last_node);
+	}
+
+private:
+	Unrolled_List(Unrolled_List const&);
+	Unrolled_List& operator=(Unrolled_List const&);
+
+	node_type* head() const {return static_cast<node_type*>(m_node.next);}
+	node_type* tail() const {return static_cast<node_type*>(m_node.prev);}
+
+	//An empty node linked in before position
+	node_type* create_node(List_Node_Base* position)
+	{
+		node_type* node = static_cast<node_type*>(m_context->allocator->allocate(
+			sizeof(node_type), std::alignment_of<node_type>::value));
+		node->count = 0;
+		insert_before(position, node);
+		return node;
+	}
+
+	//Unlinks and frees a node whose elements are already gone
+	void remove_node(node_type* node)
+	{
+		gtl::erase(node);
+		m_context->allocator->deallocate(node, sizeof(node_type), std::alignment_of<node_type>::value);
+	}
+
+	static void relocate(T* first, T* last, T* dest, true_type /*relocatable*/)
+	{
+		uninitialized_relocate(first, last, dest);
+	}
+
+	static void relocate(T* first, T* last, T* dest, false_type /*relocatable*/)
+	{
+		uninitialized_move_if_noexcept(first, last, dest);
+		destruct_range(Iterator_Range<T*>(first, last));
+	}
+
+	//Makes position the start of a node, moving the tail of its node into a
+	//new one after it.  Returns the node starting at position.
+	List_Node_Base* split(iterator position)
+	{
+		if(position.m_index == 0)
+		{
+			return position.m_node;
+		}
+
+		node_type* node = static_cast<node_type*>(position.m_node);
+		node_type* next = create_node(node->next);
+		auto guard = scope(next, [this](node_type* p){this->remove_node(p);});
+
+		relocate(node->begin() + position.m_index, node->end(), next->begin(),
+			typename is_trivially_relocatable<T>::type());
+		guard.release();
+
+		next->count = node->count - position.m_index;
+		node->count = position.m_index;
+		return next;
+	}
+
+	static void rebase(iterator& it, iterator at, List_Node_Base* node)
+	{
+		if(at.m_index != 0 && it.m_node == at.m_node && it.m_index >= at.m_index)
+		{
+			it = iterator(node, it.m_index - at.m_index);
+		}
+	}
+
+	//Places value at index of a node with room, shifting the rest up
+	static void shift_insert(node_type* node, size_t index, T* value)
+	{
+		T* first = node->begin();
+		T* finish = node->end();
+
+		if(first + index == finish)
+		{
+			new (finish) T(std::move(*value));
+		}
+		else
+		{
+			new (finish) T(std::move(*(finish - 1)));
+			std::move_backward(first + index, finish - 1, finish);
+			first[index] = std::move(*value);
+		}
+		++node->count;
+	}
+
+	void verify_transferrable(Unrolled_List& other)
+	{
+		if(m_context->allocator != other.m_context->allocator)
+		{
+			raise_exception(Exception("nodes cannot be transferred"));
+		}
+	}
+
+private:
+	Context const* m_context;
+	List_Node_Base m_node;
+	size_type m_size;
+};
+
+template <class T, size_t K>
+template <class Emplace_T>
+typename Unrolled_List<T, K>::iterator Unrolled_List<T, K>::func_emplace(iterator position, Emplace_T func)
+{
+	//Appending to the node before position needs no shifting
+	if(position.m_index == 0)
+	{
+		List_Node_Base* prev = position.m_node->prev;
+		if(prev != &m_node && static_cast<node_type*>(prev)->count < K)
+		{
+			node_type* node = static_cast<node_type*>(prev);
+			func(node->end());
+			++m_size;
+			return iterator(node, node->count++);
+		}
+
+		if(position.m_node == &m_node)
+		{
+			func_emplace_back(func);
+			return iterator(tail(), tail()->count - 1);
+		}
+	}
+
+	//Built aside, it may refer to one of the elements being shifted
+	typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+	T* value = reinterpret_cast<T*>(&storage);
+	func(value);
+	auto guard = scope(value, [](T* p){destruct(p);});
+
+	node_type* node = static_cast<node_type*>(position.m_node);
+	size_t index = position.m_index;
+	if(node->count == K)
+	{
+		size_t half = K / 2;
+		node_type* upper = static_cast<node_type*>(split(iterator(node, half)));
+		if(index >= half)
+		{
+			node = upper;
+			index -= half;
+		}
+	}
+
+	shift_insert(node, index, value);
+	++m_size;
+	return iterator(node, index);
+}
+
+template <class T, size_t K>
+typename Unrolled_List<T, K>::iterator Unrolled_List<T, K>::erase(iterator position)
+{
+	node_type* node = static_cast<node_type*>(position.m_node);
+	T* first = node->begin() + position.m_index;
+
+	std::move(first + 1, node->end(), first);
+	destruct(node->end() - 1);
+	--m_size;
+
+	if(--node->count == 0)
+	{
+		List_Node_Base* next = node->next;
+		remove_node(node);
+		return iterator(next, 0);
+	}
+
+	if(position.m_index == node->count)
+	{
+		return iterator(node->next, 0);
+	}
+
+	return position;
+}
+
+template <class T, size_t K>
+void Unrolled_List<T, K>::clear()
+{
+	List_Node_Base* current = m_node.next;
+	while(current != &m_node)
+	{
+		node_type* node = static_cast<node_type*>(current);
+		current = current->next;
+		destruct_range(Iterator_Range<T*>(node->begin(), node->end()));
+		m_context->allocator->deallocate(node, sizeof(node_type), std::alignment_of<node_type>::value);
+	}
+
+	m_node.next = &m_node;
+	m_node.prev = &m_node;
+	m_size = 0;
+}
+
+} //namespace
+
+#endif
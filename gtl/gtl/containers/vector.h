@@ -69,17 +69,42 @@ template <class T> struct Vector_Storage
 
 	~Vector_Storage()
 	{
-		deallocate(m_start);
+		deallocate(m_start, m_end - m_start);
+	}
+
+	//Whether the buffer is part of the object and can't change hands
+	bool is_inline() const
+	{
+		return false;
+	}
+
+	//Back to no buffer, the old one must be released already
+	void reset()
+	{
+		m_start = m_finish = m_end = 0;
 	}
 
 	T* allocate(size_t n)
 	{
-		return static_cast<T*>(m_context->allocator->allocate(sizeof(T) * n));
+		return static_cast<T*>(m_context->allocator->allocate(sizeof(T) * n, std::alignment_of<T>::value));
 	}
 
-	void deallocate(T* data)
+	//n is the capacity data was allocated with
+	void deallocate(T* data, size_t n)
 	{
-		m_context->allocator->deallocate(data);
+		m_context->allocator->deallocate(data, sizeof(T) * n, std::alignment_of<T>::value);
+	}
+
+	//Grows the capacity to n without moving the elements, if the allocator can
+	bool expand(size_t n)
+	{
+		if(!m_start || !m_context->allocator->try_expand(m_start, sizeof(T) * (m_end - m_start), sizeof(T) * n))
+		{
+			return false;
+		}
+
+		m_end = m_start + n;
+		return true;
 	}
 
 	Context const* m_context;
@@ -90,9 +115,10 @@ template <class T> struct Vector_Storage
 
 struct Empty_Storage_Tag {};
 
-template <class T> class Vector : private Vector_Storage<T>
+//Storage_T owns the buffer, see Vector_Storage for the interface
+template <class T, class Storage_T = Vector_Storage<T> > class Vector : private Storage_T
 {
-	typedef Vector_Storage<T> storage_type;
+	typedef Storage_T storage_type;
 
 public:
 	typedef T value_type;
@@ -123,7 +149,13 @@ public:
 		storage_type(other.m_context, other.size())
 	{
 		this->m_finish = this->m_start + other.size();
-		uninitialized_copy(other.m_start, other.m_end, this->m_start);
+		uninitialized_copy(other.m_start, other.m_finish, this->m_start);
+	}
+
+	Vector(Vector&& other) GTL_NOTHROW :
+		storage_type(other.m_context)
+	{
+		take(other);
 	}
 
 	~Vector()
@@ -133,6 +165,18 @@ public:
 
 	Vector& operator=(const Vector& x);
 
+	Vector& operator=(Vector&& x) GTL_NOTHROW
+	{
+		if(&x != this)
+		{
+			destruct_range(all());
+			this->deallocate(this->m_start, capacity());
+			this->reset();
+			take(x);
+		}
+		return *this;
+	}
+
 	iterator begin() {return this->m_start;}
 	const_iterator begin() const {return this->m_start;}
 
@@ -159,10 +203,15 @@ public:
 		func_emplace_back(gtl::emplace(x));
 	}
 
+	void push_back(value_type&& x)
+	{
+		func_emplace_back(gtl::emplace(std::move(x)));
+	}
+
 	template <class TT>
 	void emplace_back(TT&& x)
 	{
-		func_emplace_back(gtl::emplace(x));
+		func_emplace_back(gtl::emplace(std::forward<TT>(x)));
 	}
 
 	template <class Func_T>
@@ -187,7 +236,7 @@ public:
 	template <class TT>
 	void fixed_emplace_back(TT&& x)
 	{
-		fixed_func_emplace_back(gtl::emplace(x));
+		fixed_func_emplace_back(gtl::emplace(std::forward<TT>(x)));
 	}
 
 	template <class Func_T>
@@ -203,10 +252,15 @@ public:
 		return func_emplace(position, gtl::emplace(x));
 	}
 
+	iterator insert(iterator position, T&& x) 
+	{
+		return func_emplace(position, gtl::emplace(std::move(x)));
+	}
+
 	template <class TT>
 	iterator emplace(iterator position, TT&& x)
 	{
-		return func_emplace(position, gtl::emplace(x));
+		return func_emplace(position, gtl::emplace(std::forward<TT>(x)));
 	}
 
 	template <class Func_T>
@@ -241,6 +295,14 @@ public:
 
 	void swap(Vector& x)
 	{
+		if(this->is_inline() || x.is_inline())
+		{
+			Vector temp(std::move(x));
+			x = std::move(*this);
+			*this = std::move(temp);
+			return;
+		}
+
 		std::swap(this->m_context, x.m_context);
 		std::swap(this->m_start, x.m_start);
 		std::swap(this->m_finish, x.m_finish);
@@ -249,15 +311,9 @@ public:
 
 	void reserve(size_t n)
 	{
-		if(capacity() < n)
+		if(capacity() < n && !this->expand(n))
 		{
-			const size_t old_size = size();
-			iterator tmp = allocate_and_copy(n, this->m_start, this->m_finish);
-			destruct_range(all());
-			this->deallocate(this->m_start);
-			this->m_start = tmp;
-			this->m_finish = tmp + old_size;
-			this->m_end = this->m_start + n;
+			grow_insert(end(), 0, n, [](T*){});
 		}
 	}
 
@@ -271,7 +327,7 @@ public:
 	{
 		if (position + 1 != end())
 		{
-			copy(position + 1, this->m_finish, position);
+			std::move(position + 1, this->m_finish, position);
 		}
 		--this->m_finish;
 		destruct(this->m_finish);
@@ -280,7 +336,7 @@ public:
 
 	iterator erase(iterator first, iterator last)
 	{
-		iterator i = copy(last, this->m_finish, first);
+		iterator i = std::move(last, this->m_finish, first);
 		destruct_range(range(i, this->m_finish));
 		this->m_finish = this->m_finish - (last - first);
 		return first;
@@ -305,15 +361,61 @@ private:
 	template <class Forward_Iterator>
 	iterator allocate_and_copy(size_t n, Forward_Iterator first, Forward_Iterator last)
 	{
-		auto deleter = [this](T* p){this->deallocate(p);};
+		auto deleter = [this, n](T* p){this->deallocate(p, n);};
 		auto result = scope(this->allocate(n), deleter);
 		uninitialized_copy(first, last, result.get());
 		return result.release();
 	}
 
+	//Moves the contents of other into this empty vector
+	void take(Vector& other)
+	{
+		this->m_context = other.m_context;
+
+		if(other.is_inline())
+		{
+			this->m_finish = uninitialized_copy(
+				std::make_move_iterator(other.m_start), std::make_move_iterator(other.m_finish), this->m_start);
+			other.clear();
+		}
+		else
+		{
+			this->m_start = other.m_start;
+			this->m_finish = other.m_finish;
+			this->m_end = other.m_end;
+			other.reset();
+		}
+	}
+
+	//Moves [m_start, position) to before and [position, m_finish) to after,
+	//leaving the old buffer as raw memory
+	void relocate_split(iterator position, T* before, T* after, true_type /*relocatable*/)
+	{
+		uninitialized_relocate(this->m_start, position, before);
+		uninitialized_relocate(position, this->m_finish, after);
+	}
+
+	void relocate_split(iterator position, T* before, T* after, false_type /*relocatable*/)
+	{
+		T* mid = uninitialized_move_if_noexcept(this->m_start, position, before);
+
+		GTL_TRY
+		{
+			uninitialized_move_if_noexcept(position, this->m_finish, after);
+		}
+		GTL_UNWIND(destruct_range(range(before, mid)))
+
+		destruct_range(all());
+	}
+
 	template <class Func_T>
 	void insert_aux(iterator position, Func_T emplace_func);
 
+	//Moves everything to a new buffer of len, with construct_func filling
+	//the n element gap at position
+	template <class Construct_Func>
+	void grow_insert(iterator position, size_t n, size_t len, Construct_Func construct_func);
+
 	void fill_insert(iterator position, size_t n, const T& x);
 
 	template <class Input_Iter>
@@ -331,33 +433,69 @@ private:
 private:
 };
 
-template <class T> template <class Func_T>
-void Vector<T>::insert_aux(iterator position, Func_T emplace_func)
+template <class T, class Storage_T> template <class Func_T>
+void Vector<T, Storage_T>::insert_aux(iterator position, Func_T emplace_func)
 {
-	if(this->m_finish != this->m_end)
+	if(this->m_finish == this->m_end)
+	{
+		const size_t old_size = size();
+		const size_t len = old_size != 0 ? 2 * old_size : 1;
+		const size_t index = position - this->m_start;
+
+		if(!this->expand(len))
+		{
+			grow_insert(position, 1, len, emplace_func);
+			return;
+		}
+
+		position = this->m_start + index;
+	}
+
+	if(position == this->m_finish)
 	{
-		copy_construct(this->m_finish, *(this->m_finish - 1));
+		emplace_func(this->m_finish);
 		++this->m_finish;
-		copy_backward(position, this->m_finish - 2, this->m_finish - 1);
-		emplace_func(position);
 	}
 	else
 	{
-		const size_t old_size = size();
-		const size_t len = old_size != 0 ? 2 * old_size : 1;
+		//Built aside, it may refer to one of the elements being shifted
+		typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+		T* value = reinterpret_cast<T*>(&storage);
+		emplace_func(value);
+		auto guard = scope(value, [](T* p){destruct(p);});
 
-		Vector temp(this->m_context, len, Empty_Storage_Tag());
+		new (this->m_finish) T(std::move(*(this->m_finish - 1)));
+		++this->m_finish;
+		std::move_backward(position, this->m_finish - 2, this->m_finish - 1);
+		*position = std::move(*value);
+	}
+}
+
+template <class T, class Storage_T> template <class Construct_Func>
+void Vector<T, Storage_T>::grow_insert(iterator position, size_t n, size_t len, Construct_Func construct_func)
+{
+	auto deleter = [this, len](T* p){this->deallocate(p, len);};
+	auto temp = scope(this->allocate(len), deleter);
 
-		temp.m_finish = uninitialized_copy(this->m_start, position, temp.m_start);
-		emplace_func(temp.m_finish);
-		++temp.m_finish;
-		temp.m_finish = uninitialized_copy(position, this->m_finish, temp.m_finish);
+	//New elements first, they may refer to the old ones
+	T* slot = temp.get() + (position - this->m_start);
+	construct_func(slot);
 
-		swap(temp);
+	GTL_TRY
+	{
+		relocate_split(position, temp.get(), slot + n, typename is_trivially_relocatable<T>::type());
 	}
+	GTL_UNWIND(destruct_range(range(slot, slot + n)))
+
+	const size_t new_size = size() + n;
+	this->deallocate(this->m_start, capacity());
+	this->m_start = temp.release();
+	this->m_finish = this->m_start + new_size;
+	this->m_end = this->m_start + len;
 }
-template <class T>
-void Vector<T>::fill_insert(iterator position, size_t n, const T& x)
+
+template <class T, class Storage_T>
+void Vector<T, Storage_T>::fill_insert(iterator position, size_t n, const T& x)
 {
 	if (n != 0)
 	{
@@ -368,16 +506,16 @@ void Vector<T>::fill_insert(iterator position, size_t n, const T& x)
 			iterator old_finish = this->m_finish;
 			if (elems_after > n)
 			{
-				uninitialized_copy(this->m_finish - n, this->m_finish, this->m_finish);
+				uninitialized_move_if_noexcept(this->m_finish - n, this->m_finish, this->m_finish);
 				this->m_finish += n;
-				copy_backward(position, old_finish - n, old_finish);
+				std::move_backward(position, old_finish - n, old_finish);
 				fill(position, position + n, x_copy);
 			}
 			else
 			{
 				uninitialized_fill_n(this->m_finish, n - elems_after, x_copy);
 				this->m_finish += n - elems_after;
-				uninitialized_copy(position, old_finish, this->m_finish);
+				uninitialized_move_if_noexcept(position, old_finish, this->m_finish);
 				this->m_finish += elems_after;
 				fill(position, old_finish, x_copy);
 			}
@@ -386,20 +524,21 @@ void Vector<T>::fill_insert(iterator position, size_t n, const T& x)
 		{
 			const size_t old_size = size();        
 			const size_t len = old_size + std::max(old_size, n);
-			Vector temp(this->m_context, len, Empty_Storage_Tag());
+			const size_t index = position - this->m_start;
 
-			temp.m_finish = uninitialized_copy(this->m_start, position, temp.m_start);
-			uninitialized_fill_n(temp.m_finish, n, x);
-			temp.m_finish += n;
-			temp.m_finish = uninitialized_copy(position, this->m_finish, temp.m_finish);
+			if(this->expand(len))
+			{
+				fill_insert(this->m_start + index, n, x);
+				return;
+			}
 
-			swap(temp);
+			grow_insert(position, n, len, [&](T* p){uninitialized_fill_n(p, n, x);});
 		}
 	}
 }
 
-template <class T> template <class Input_Iter>
-void Vector<T>::range_insert(
+template <class T, class Storage_T> template <class Input_Iter>
+void Vector<T, Storage_T>::range_insert(
 	iterator pos, 
 	Input_Iter first, 
 	Input_Iter last,
@@ -412,8 +551,8 @@ void Vector<T>::range_insert(
 	}
 }
 
-template <class T> template <class Forward_Iter>
-void Vector<T>::range_insert(
+template <class T, class Storage_T> template <class Forward_Iter>
+void Vector<T, Storage_T>::range_insert(
 	iterator position,
 	Forward_Iter first,
 	Forward_Iter last,
@@ -428,9 +567,9 @@ void Vector<T>::range_insert(
 			iterator old_finish = this->m_finish;
 			if (elems_after > n)
 			{
-				uninitialized_copy(this->m_finish - n, this->m_finish, this->m_finish);
+				uninitialized_move_if_noexcept(this->m_finish - n, this->m_finish, this->m_finish);
 				this->m_finish += n;
-				copy_backward(position, old_finish - n, old_finish);
+				std::move_backward(position, old_finish - n, old_finish);
 				copy(first, last, position);
 			}
 			else
@@ -439,7 +578,7 @@ void Vector<T>::range_insert(
 				std::advance(mid, elems_after);
 				uninitialized_copy(mid, last, this->m_finish);
 				this->m_finish += n - elems_after;
-				uninitialized_copy(position, old_finish, this->m_finish);
+				uninitialized_move_if_noexcept(position, old_finish, this->m_finish);
 				this->m_finish += elems_after;
 				copy(first, mid, position);
 			}
@@ -448,19 +587,21 @@ void Vector<T>::range_insert(
 		{
 			const size_t old_size = size();
 			const size_t len = old_size + std::max(old_size, n);
+			const size_t index = position - this->m_start;
 
-			Vector temp(this->m_context, len, Empty_Storage_Tag());
-			temp.m_finish = uninitialized_copy(this->m_start, position, temp.m_start);
-			temp.m_finish = uninitialized_copy(first, last, temp.m_finish);
-			temp.m_finish = uninitialized_copy(position, this->m_finish, temp.m_finish);
+			if(this->expand(len))
+			{
+				range_insert(this->m_start + index, first, last, std::forward_iterator_tag());
+				return;
+			}
 
-			swap(temp);
+			grow_insert(position, n, len, [&](T* p){uninitialized_copy(first, last, p);});
 		}
 	}
 }
 
-template <class T> template <class Input_Iter>
-void Vector<T>::assign_aux(Input_Iter first, Input_Iter last, std::input_iterator_tag)
+template <class T, class Storage_T> template <class Input_Iter>
+void Vector<T, Storage_T>::assign_aux(Input_Iter first, Input_Iter last, std::input_iterator_tag)
 {
 	iterator cur = begin();
 	for ( ; first != last && cur != end(); ++cur, ++first)
@@ -471,8 +612,8 @@ void Vector<T>::assign_aux(Input_Iter first, Input_Iter last, std::input_iterato
 		insert(end(), first, last);
 }
 
-template <class T> template <class Forward_Iter>
-void Vector<T>::assign_aux(Forward_Iter first, Forward_Iter last, std::forward_iterator_tag)
+template <class T, class Storage_T> template <class Forward_Iter>
+void Vector<T, Storage_T>::assign_aux(Forward_Iter first, Forward_Iter last, std::forward_iterator_tag)
 {
 	size_t len = std::distance(first, last);
 
@@ -480,7 +621,7 @@ void Vector<T>::assign_aux(Forward_Iter first, Forward_Iter last, std::forward_i
 	{
 		iterator tmp = allocate_and_copy(len, first, last);
 		destruct_range(all());
-		this->deallocate(this->m_start);
+		this->deallocate(this->m_start, capacity());
 		this->m_start = tmp;
 		this->m_end = m_finish = this->m_start + len;
 	}
@@ -499,8 +640,8 @@ void Vector<T>::assign_aux(Forward_Iter first, Forward_Iter last, std::forward_i
 	}
 }
 
-template <class T>
-Vector<T>& Vector<T>::operator=(const Vector<T>& x)
+template <class T, class Storage_T>
+Vector<T, Storage_T>& Vector<T, Storage_T>::operator=(const Vector& x)
 {
 	if (&x != this)
 	{
@@ -509,7 +650,7 @@ Vector<T>& Vector<T>::operator=(const Vector<T>& x)
 		{
 			iterator tmp = allocate_and_copy(xlen, x.begin(), x.end());
 			destruct_range(all());
-			this->deallocate(this->m_start);
+			this->deallocate(this->m_start, capacity());
 			this->m_start = tmp;
 			this->m_end = this->m_start + xlen;
 		}
@@ -528,6 +669,11 @@ Vector<T>& Vector<T>::operator=(const Vector<T>& x)
 	return *this;
 }
 
+//Owns nothing but pointers to its buffer, safe to memcpy around
+template <class T> struct is_trivially_relocatable<Vector<T>> : true_type
+{
+};
+
 } //namespace
 
 #endif
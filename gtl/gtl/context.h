@@ -30,13 +30,32 @@ struct Context
 	{
 	}
 
+	//Unlike new (context), honours alignments stricter than the default.
+	//Free with destroy_created.
+	template <class T, class Emplace_Func> T* create(Emplace_Func func) const
+	{
+		void* mem = allocator->allocate(sizeof(T), std::alignment_of<T>::value);
+		auto deleter = [this](void* p){allocator->deallocate(p, sizeof(T), std::alignment_of<T>::value);};
+		auto result(scope(mem, deleter));
+		func(static_cast<T*>(mem));
+		return static_cast<T*>(result.release());
+	}
+
 	//p must be the concrete type that was allocated! (no virtual deallocation).
 	//creator frees is the GTL policy
+	//Pairs with new (context), which allocates without the alignment of T
 	template <class T> void destroy(T* p) const
 	{
 		destruct(p);
 		allocator->deallocate(p);
 	}
+
+	//Pairs with create
+	template <class T> void destroy_created(T* p) const
+	{
+		destruct(p);
+		allocator->deallocate(p, sizeof(T), std::alignment_of<T>::value);
+	}
 	
 	Allocator* allocator;
 };
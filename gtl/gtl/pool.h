@@ -18,5 +18,6 @@
 #define GTL_POOL_H
 
 #include "pool/pool.h"
+#include "pool/concurrent_pool.h"
 
 #endif
@@ -0,0 +1,345 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GTL_POOL_CONCURRENT_POOL_H
+#define GTL_POOL_CONCURRENT_POOL_H
+
+#include <gtl/config.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/containers/emplace.h>
+#include <gtl/debug.h>
+#include <atomic>
+#include <mutex>
+#include "pool.h"
+
+namespace gtl {
+
+//Pool shared between threads.  Each thread allocates and frees through its
+//own Cache, which holds up to two magazines (chains of magazine_size links).
+//Full magazines are exchanged with a lock-free depot, the backing Pool is
+//only locked when the depot can't satisfy a refill or has no room left.
+class Concurrent_Pool : private Noncopyable
+{
+public:
+	class Cache;
+
+	Concurrent_Pool(Context const* context, size_t elem_size, size_t elem_align,
+		Pool_Policy const& policy, size_t magazine_size = 32, size_t depot_size = 16) :
+		m_context(context),
+		m_pool(context, elem_size, elem_align, policy),
+		m_magazine_size(std::max(magazine_size, size_t(1))),
+		m_depot_size(std::max(depot_size, size_t(1)))
+	{
+		m_depot = static_cast<std::atomic<char*>*>(
+			m_context->allocator->allocate(sizeof(std::atomic<char*>) * m_depot_size));
+
+		for(size_t i = 0; i < m_depot_size; ++i)
+		{
+			new (m_depot + i) std::atomic<char*>(0);
+		}
+	}
+
+	~Concurrent_Pool()
+	{
+		//Caches must be gone by now, the depot only refers to pool memory
+		m_context->allocator->deallocate(m_depot);
+	}
+
+	size_t magazine_size() const
+	{
+		return m_magazine_size;
+	}
+
+	size_t capacity()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_pool.capacity();
+	}
+
+private:
+	static char* & next(char* link)
+	{
+		return *reinterpret_cast<char**>(link);
+	}
+
+	//Takes a full magazine from the depot, starting the scan at hint
+	char* take_magazine(size_t& hint)
+	{
+		for(size_t i = 0; i < m_depot_size; ++i)
+		{
+			size_t slot = (hint + i) % m_depot_size;
+			if(m_depot[slot].load(std::memory_order_relaxed))
+			{
+				//Exchange claims the whole chain, no ABA window
+				if(char* chain = m_depot[slot].exchange(0, std::memory_order_acquire))
+				{
+					hint = slot;
+					return chain;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	bool give_magazine(char* chain, size_t& hint)
+	{
+		for(size_t i = 0; i < m_depot_size; ++i)
+		{
+			size_t slot = (hint + i) % m_depot_size;
+			char* expected = 0;
+			if(m_depot[slot].compare_exchange_strong(expected, chain,
+				std::memory_order_release, std::memory_order_relaxed))
+			{
+				hint = slot;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//Builds a magazine straight from the backing pool, short if a pool
+	//that can't grow runs out.  count gets the links actually taken.
+	char* refill(size_t& count)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		char* chain = 0;
+		for(count = 0; count < m_magazine_size && !m_pool.empty(); ++count)
+		{
+			char* link = static_cast<char*>(m_pool.allocate());
+			next(link) = chain;
+			chain = link;
+		}
+
+		return chain;
+	}
+
+	//Returns a chain of links to the backing pool
+	void release(char* chain)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		while(chain)
+		{
+			char* link = chain;
+			chain = next(chain);
+			m_pool.deallocate(link);
+		}
+	}
+
+private:
+	Context const* m_context;
+	Pool m_pool;
+	std::mutex m_lock;
+	std::atomic<char*>* m_depot;
+	size_t m_magazine_size;
+	size_t m_depot_size;
+};
+
+//Per thread front end, not to be shared.  Links may be freed through any
+//Cache of the same pool, regardless of which one allocated them.
+class Concurrent_Pool::Cache : private Noncopyable
+{
+public:
+	Cache(Concurrent_Pool& pool) :
+		m_pool(pool),
+		m_loaded(0),
+		m_loaded_count(0),
+		m_previous(0),
+		m_hint(0)
+	{
+	}
+
+	~Cache()
+	{
+		flush();
+	}
+
+	//Null once a pool that can't grow is exhausted
+	void* allocate()
+	{
+		if(m_loaded_count == 0 && !load())
+		{
+			GTL_ASSERT(!"concurrent pool exhausted");
+			return 0;
+		}
+
+		char* link = m_loaded;
+		m_loaded = next(link);
+		--m_loaded_count;
+		return link;
+	}
+
+	void deallocate(void* p)
+	{
+		if(m_loaded_count == m_pool.m_magazine_size)
+		{
+			unload();
+		}
+
+		char* link = static_cast<char*>(p);
+		next(link) = m_loaded;
+		m_loaded = link;
+		++m_loaded_count;
+	}
+
+	//Hands everything cached back to the backing pool
+	void flush()
+	{
+		if(m_loaded)
+		{
+			m_pool.release(m_loaded);
+		}
+
+		if(m_previous)
+		{
+			m_pool.release(m_previous);
+		}
+
+		m_loaded = 0;
+		m_loaded_count = 0;
+		m_previous = 0;
+	}
+
+private:
+	static char* & next(char* link)
+	{
+		return Concurrent_Pool::next(link);
+	}
+
+	//False if nothing could be had
+	bool load()
+	{
+		if(m_previous)
+		{
+			//The previous magazine is always full
+			m_loaded = m_previous;
+			m_previous = 0;
+			m_loaded_count = m_pool.m_magazine_size;
+		}
+		else if((m_loaded = m_pool.take_magazine(m_hint)) != 0)
+		{
+			m_loaded_count = m_pool.m_magazine_size;
+		}
+		else
+		{
+			m_loaded = m_pool.refill(m_loaded_count);
+		}
+
+		return m_loaded_count != 0;
+	}
+
+	void unload()
+	{
+		if(m_previous && !m_pool.give_magazine(m_previous, m_hint))
+		{
+			m_pool.release(m_previous);
+		}
+
+		m_previous = m_loaded;
+		m_loaded = 0;
+		m_loaded_count = 0;
+	}
+
+private:
+	Concurrent_Pool& m_pool;
+	char* m_loaded;
+	size_t m_loaded_count;
+	char* m_previous;
+	size_t m_hint;
+};
+
+template <class T> class Concurrent_Node_Pool : private Noncopyable
+{
+public:
+	class Cache : private Noncopyable
+	{
+	public:
+		Cache(Concurrent_Node_Pool& pool) : m_cache(pool.m_pool) {}
+
+		T* allocate()
+		{
+			return static_cast<T*>(m_cache.allocate());
+		}
+
+		void deallocate(T* p)
+		{
+			m_cache.deallocate(p);
+		}
+
+		T* create()
+		{
+			return create(emplace());
+		}
+
+		T* create(T const& x)
+		{
+			return create(emplace(x));
+		}
+
+		template <class Emplace_Func>
+		T* create(Emplace_Func func)
+		{
+			auto deleter = [this](T* p){this->deallocate(p);};
+			auto result(scope(allocate(), deleter));
+			func(result.get());
+			return result.release();
+		}
+
+		void destroy(T* p)
+		{
+			destruct(p);
+			m_cache.deallocate(p);
+		}
+
+		template <class Range_T>
+		void destroy_range(Range_T range)
+		{
+			for(; !range.empty(); range.pop())
+			{
+				destroy(range.get());
+			}
+		}
+
+		void flush()
+		{
+			m_cache.flush();
+		}
+
+	private:
+		Concurrent_Pool::Cache m_cache;
+	};
+
+	Concurrent_Node_Pool(Context const* context, Pool_Policy const& policy, size_t magazine_size = 32) :
+		m_pool(context, sizeof(T), std::alignment_of<T>::value, policy, magazine_size)
+	{
+	}
+
+	size_t capacity()
+	{
+		return m_pool.capacity();
+	}
+
+private:
+	Concurrent_Pool m_pool;
+};
+
+}
+
+#endif
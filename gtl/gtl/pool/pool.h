@@ -26,63 +26,136 @@
 
 namespace gtl {
 
+//Describes how a pool acquires its memory.  By default a pool is a single
+//fixed slab of count links, growth chains additional slabs on demand.  A
+//growable pool with a count of 0 defers its first slab to the first allocate.
+struct Pool_Policy
+{
+	explicit Pool_Policy(size_t count) :
+		count(count),
+		growth(0.0f),
+		max_count(count),
+		high_water(0),
+		link_offset(0)
+	{
+	}
+
+	//Chain a new slab when the pool runs dry, each slab is factor times the
+	//size of the previous one, up to max_count links
+	Pool_Policy& grow(float factor, size_t max)
+	{
+		growth = factor;
+		max_count = max;
+		return *this;
+	}
+
+	//Return fully free slabs to the allocator once more than free links
+	//sit idle in the pool
+	Pool_Policy& release_above(size_t free)
+	{
+		high_water = free;
+		return *this;
+	}
+
+	//Keep the free list pointer at offset inside each link, so elements
+	//already chained through that field can be returned in one step
+	Pool_Policy& link_at(size_t offset)
+	{
+		link_offset = offset;
+		return *this;
+	}
+
+	size_t count;
+	float growth;
+	size_t max_count;
+	size_t high_water;
+	size_t link_offset;
+};
+
+//Offset of the pointer a Node_Pool<T> threads its free list through,
+//specialized by node types that link themselves (see List_Node_T)
+template <class T> struct pool_link_offset : std::integral_constant<size_t, 0>
+{
+};
+
 class Pool
 {
+	//Lives at the head of every slab.  Besides the list, slabs form a treap
+	//ordered by address, so finding the slab of a link is logarithmic
+	struct Slab
+	{
+		Slab* next;
+		char* begin;
+		char* end;
+		size_t base; //offset of the first link, keeps offset_of stable
+		size_t free; //scratch counter for trim
+		Slab* left;
+		Slab* right;
+		size_t priority;
+	};
+
 public:
 	Pool(Context const* context, size_t elem_size, size_t elem_align, size_t count) :
 		m_context(context),
-		m_pool(0),
-		m_pool_end(0),
-		m_free(0)
+		m_policy(count)
 	{
-		//Calculate the characteristics of the actual link
-		size_t link_size = std::max(elem_size, sizeof(char*));
-		size_t link_align = details::lcm(elem_align, std::alignment_of<char*>::value);
-
-		size_t remainder = link_size % link_align;
-		if(remainder != 0)
-		{
-			//Adjust the link size with padding
-			link_size += link_align - remainder;
-		}
-
-		size_t pool_size = link_size * count;
-		m_link_size = link_size;
-		m_pool = static_cast<char*>(m_context->allocator->allocate(pool_size));
-		m_pool_end = m_pool + pool_size;
+		init(elem_size, elem_align);
+	}
 
-		//Push backwards, we want to serve from the top
-		char* link = m_pool_end;
-		while(link > m_pool)
-		{
-			link = link - link_size;
-			push_free(link);
-		}
+	Pool(Context const* context, size_t elem_size, size_t elem_align, Pool_Policy const& policy) :
+		m_context(context),
+		m_policy(policy)
+	{
+		init(elem_size, elem_align);
 	}
 
 	~Pool()
 	{
-		m_context->allocator->deallocate(m_pool);
+		while(m_slabs)
+		{
+			Slab* slab = m_slabs;
+			m_slabs = slab->next;
+			m_context->allocator->deallocate(slab);
+		}
 	}
 
 	size_t offset_of(void const* p) const
 	{
 		char const* ptr = (char const*) p;
-		GTL_ASSERT(ptr >= m_pool && ptr < m_pool_end);
-		return (ptr - m_pool) / m_link_size;
+		Slab const* slab = find_slab(ptr);
+		GTL_ASSERT(slab);
+		return slab->base + (ptr - slab->begin) / m_link_size;
 	}
 
+	bool growable() const
+	{
+		return m_policy.growth > 0.0f;
+	}
+
+	//True if the next allocate cannot be served
 	bool empty() const
 	{
-		return m_free == 0;
+		return m_free == 0 && !growable();
+	}
+
+	//Links currently owned by the pool, free or not
+	size_t capacity() const
+	{
+		return m_capacity;
 	}
 
 	void* allocate()
 	{
-		GTL_ASSERT(!empty());
+		if(m_free == 0 && growable())
+		{
+			add_slab();
+		}
+
+		GTL_ASSERT(m_free != 0);
 
 		void* ret = m_free;
 		m_free = next(m_free);
+		--m_free_count;
 		return ret;
 	}
 
@@ -90,35 +163,346 @@ public:
 	{
 		char* link = static_cast<char*>(p);
 		//Must came from the pool
-		GTL_ASSERT(link >= m_pool && link < m_pool_end);
+		GTL_ASSERT(find_slab(link));
 		push_free(link);
+		check_trim();
+	}
+
+	//Returns count links in one step, first to last must already be
+	//chained through the pointer at the policy's link offset
+	void deallocate_chain(void* first, void* last, size_t count)
+	{
+		GTL_ASSERT(find_slab(static_cast<char*>(first)) && find_slab(static_cast<char*>(last)));
+		next(static_cast<char*>(last)) = m_free;
+		m_free = static_cast<char*>(first);
+		m_free_count += count;
+		check_trim();
+	}
+
+	//Releases fully free slabs while at least keep free links remain,
+	//returns the number of links released
+	size_t trim(size_t keep = 0);
+
+	//Calculate the characteristics of the actual link
+	static size_t link_size(size_t elem_size, size_t elem_align)
+	{
+		size_t link_align = details::lcm(elem_align, std::alignment_of<char*>::value);
+		return round_up(std::max(elem_size, sizeof(char*)), link_align);
+	}
+
+	//Bytes in front of the links of every slab
+	static size_t header_size(size_t elem_align)
+	{
+		size_t link_align = details::lcm(elem_align, std::alignment_of<char*>::value);
+		return round_up(sizeof(Slab), details::lcm(link_align, std::alignment_of<Slab>::value));
+	}
+
+	//Number of links that fit in a slab of the given size
+	static size_t slab_capacity(size_t elem_size, size_t elem_align, size_t slab_size)
+	{
+		size_t header = header_size(elem_align);
+		return slab_size > header ? (slab_size - header) / link_size(elem_size, elem_align) : 0;
 	}
 
 private:
+	void init(size_t elem_size, size_t elem_align)
+	{
+		m_link_size = link_size(elem_size, elem_align);
+		GTL_ASSERT(m_policy.link_offset % std::alignment_of<char*>::value == 0);
+		GTL_ASSERT(m_policy.link_offset + sizeof(char*) <= m_link_size);
+		m_header_size = header_size(elem_align);
+		m_slabs = 0;
+		m_root = 0;
+		m_seed = 1;
+		m_free = 0;
+		m_free_count = 0;
+		m_capacity = 0;
+		m_next_base = 0;
+		m_last_count = 0;
+		m_trim_at = m_policy.high_water;
+
+		if(m_policy.count != 0)
+		{
+			add_slab(m_policy.count);
+		}
+	}
+
+	void check_trim()
+	{
+		if(m_trim_at != 0 && m_free_count > m_trim_at)
+		{
+			//Back off if nothing could be released, so a fragmented pool
+			//doesn't rescan on every deallocation
+			if(trim(m_policy.high_water) == 0)
+			{
+				m_trim_at = m_free_count * 2;
+			}
+		}
+	}
+
+	static size_t round_up(size_t size, size_t align)
+	{
+		size_t remainder = size % align;
+		if(remainder != 0)
+		{
+			//Adjust the size with padding
+			size += align - remainder;
+		}
+		return size;
+	}
+
+	void add_slab()
+	{
+		//A pool constructed empty starts out at the maximum slab size
+		size_t count = m_last_count ?
+			static_cast<size_t>(m_last_count * m_policy.growth) : m_policy.max_count;
+		count = std::min(std::max(count, size_t(1)), std::max(m_policy.max_count, size_t(1)));
+		add_slab(count);
+		m_trim_at = m_policy.high_water;
+	}
+
+	void add_slab(size_t count)
+	{
+		size_t slab_size = m_header_size + m_link_size * count;
+		char* mem = static_cast<char*>(m_context->allocator->allocate(slab_size));
+
+		Slab* slab = reinterpret_cast<Slab*>(mem);
+		slab->begin = mem + m_header_size;
+		slab->end = mem + slab_size;
+		slab->base = m_next_base;
+		slab->next = m_slabs;
+		m_slabs = slab;
+		slab->left = slab->right = 0;
+		m_seed = m_seed * 1103515245 + 12345;
+		slab->priority = m_seed >> 16;
+		insert(m_root, slab);
+
+		m_next_base += count;
+		m_last_count = count;
+		m_capacity += count;
+
+		//Push backwards, we want to serve from the top
+		char* link = slab->end;
+		while(link > slab->begin)
+		{
+			link = link - m_link_size;
+			push_free(link);
+		}
+	}
+
+	//The slab starting last at or before ptr, if ptr lies inside it
+	Slab* find_slab(char const* ptr) const
+	{
+		Slab* found = 0;
+		for(Slab* slab = m_root; slab; )
+		{
+			if(slab->begin <= ptr)
+			{
+				found = slab;
+				slab = slab->right;
+			}
+			else
+			{
+				slab = slab->left;
+			}
+		}
+
+		return found && ptr < found->end ? found : 0;
+	}
+
+	//Cheap when consecutive links share a slab, as free lists mostly do
+	Slab* find_slab(char const* ptr, Slab* hint) const
+	{
+		return hint && ptr >= hint->begin && ptr < hint->end ? hint : find_slab(ptr);
+	}
+
+	static void insert(Slab*& root, Slab* slab)
+	{
+		if(!root)
+		{
+			root = slab;
+		}
+		else if(slab->priority > root->priority)
+		{
+			split(root, slab->begin, slab->left, slab->right);
+			root = slab;
+		}
+		else
+		{
+			insert(slab->begin < root->begin ? root->left : root->right, slab);
+		}
+	}
+
+	static void erase(Slab*& root, Slab* slab)
+	{
+		if(root == slab)
+		{
+			root = merge(slab->left, slab->right);
+		}
+		else
+		{
+			erase(slab->begin < root->begin ? root->left : root->right, slab);
+		}
+	}
+
+	//Slabs before key go to left, the rest to right
+	static void split(Slab* root, char const* key, Slab*& left, Slab*& right)
+	{
+		if(!root)
+		{
+			left = right = 0;
+		}
+		else if(root->begin < key)
+		{
+			split(root->right, key, root->right, right);
+			left = root;
+		}
+		else
+		{
+			split(root->left, key, left, root->left);
+			right = root;
+		}
+	}
+
+	//Every slab in left lies before those in right
+	static Slab* merge(Slab* left, Slab* right)
+	{
+		if(!left || !right)
+		{
+			return left ? left : right;
+		}
+
+		if(left->priority > right->priority)
+		{
+			left->right = merge(left->right, right);
+			return left;
+		}
+
+		right->left = merge(left, right->left);
+		return right;
+	}
+
+	size_t slab_count(Slab const* slab) const
+	{
+		return (slab->end - slab->begin) / m_link_size;
+	}
+
 	char* & next(char* link)
 	{
-		return *reinterpret_cast<char**>(link);
+		return *reinterpret_cast<char**>(link + m_policy.link_offset);
 	}
 
 	void push_free(char* link)
 	{
 		next(link) = m_free;
 		m_free = link;
+		++m_free_count;
 	}
 
 private:
 	Context const* m_context;
+	Pool_Policy m_policy;
 	size_t m_link_size;
-	char* m_pool;
-	char* m_pool_end;
+	size_t m_header_size;
+	Slab* m_slabs;
+	Slab* m_root;
+	size_t m_seed;
 	char* m_free;
+	size_t m_free_count;
+	size_t m_capacity;
+	size_t m_next_base;
+	size_t m_last_count;
+	size_t m_trim_at;
 };
 
+inline size_t Pool::trim(size_t keep)
+{
+	for(Slab* slab = m_slabs; slab; slab = slab->next)
+	{
+		slab->free = 0;
+	}
+
+	Slab* slab_hint = 0;
+	for(char* link = m_free; link; link = next(link))
+	{
+		slab_hint = find_slab(link, slab_hint);
+		slab_hint->free++;
+	}
+
+	//Pick the slabs to release, marked by a zeroed counter
+	size_t remaining = m_free_count;
+	size_t released = 0;
+	for(Slab* slab = m_slabs; slab; slab = slab->next)
+	{
+		size_t count = slab_count(slab);
+		if(slab->free == count && remaining >= keep + count)
+		{
+			remaining -= count;
+			released += count;
+			slab->free = 0;
+		}
+		else
+		{
+			//Non-zero for any slab that stays
+			slab->free = 1;
+		}
+	}
+
+	if(released == 0)
+	{
+		return 0;
+	}
+
+	//Rebuild the free list without the links of released slabs, preserving order
+	char* head = 0;
+	char** tail = &head;
+	slab_hint = 0;
+	for(char* link = m_free; link; link = next(link))
+	{
+		slab_hint = find_slab(link, slab_hint);
+		if(slab_hint->free)
+		{
+			*tail = link;
+			tail = &next(link);
+		}
+	}
+	*tail = 0;
+	m_free = head;
+
+	for(Slab** slab = &m_slabs; *slab; )
+	{
+		Slab* current = *slab;
+		if(current->free == 0)
+		{
+			*slab = current->next;
+			erase(m_root, current);
+			m_context->allocator->deallocate(current);
+		}
+		else
+		{
+			slab = &current->next;
+		}
+	}
+
+	m_free_count = remaining;
+	m_capacity -= released;
+	m_trim_at = m_policy.high_water;
+	return released;
+}
+
 template <class T> class Node_Pool
 {
 public:
 	Node_Pool(Context const* context, size_t count) : 
-		m_pool(context, sizeof(T), std::alignment_of<T>::value, count),
+		m_pool(context, sizeof(T), std::alignment_of<T>::value,
+			Pool_Policy(count).link_at(pool_link_offset<T>::value)),
+		m_outstanding(0)
+	{
+	}
+
+	Node_Pool(Context const* context, Pool_Policy const& policy) : 
+		m_pool(context, sizeof(T), std::alignment_of<T>::value,
+			Pool_Policy(policy).link_at(pool_link_offset<T>::value)),
 		m_outstanding(0)
 	{
 	}
@@ -138,6 +522,12 @@ public:
 		m_pool.deallocate(p);
 	}
 
+	//first to last must be chained through the pool_link_offset<T> pointer
+	void deallocate_chain(T* first, T* last, size_t count)
+	{
+		m_pool.deallocate_chain(first, last, count);
+	}
+
 	size_t offset_of(T* p)
 	{
 		return m_pool.offset_of(p);
@@ -185,6 +575,21 @@ public:
 		return m_pool.empty();
 	}
 
+	size_t capacity() const
+	{
+		return m_pool.capacity();
+	}
+
+	size_t outstanding() const
+	{
+		return m_outstanding;
+	}
+
+	size_t trim(size_t keep = 0)
+	{
+		return m_pool.trim(keep);
+	}
+
 private:
 	Pool m_pool;
 	size_t m_outstanding;
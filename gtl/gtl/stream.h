@@ -21,5 +21,6 @@
 #include "stream/range_adapters.h"
 #include "stream/container_adapters.h"
 #include "stream/stream_adapters.h"
+#include "stream/pipeline.h"
 
 #endif
@@ -18,11 +18,28 @@
 #define GTL_STREAM_CONTAINER_ADAPTERS_H
 
 #include <gtl/common.h>
+#include <gtl/containers/vector.h>
 #include "stream.h"
 #include "range_adapters.h"
 
 namespace gtl {
 
+template <class T, class Container_T>
+void container_append(Container_T& container, T const* buffer, size_t count)
+{
+	for(T const* end = buffer + count; buffer != end; ++buffer)
+	{
+		container.push_back(*buffer);
+	}
+}
+
+//Grows once, and copies the block as a whole when it can
+template <class T, class Storage_T>
+void container_append(Vector<T, Storage_T>& container, T const* buffer, size_t count)
+{
+	container.insert(container.end(), buffer, buffer + count);
+}
+
 template <class T, class Container_T> class Container_Output_Stream :
 	public Output_Stream<T>
 {
@@ -32,6 +49,12 @@ public:
 	virtual void put(T data) {m_container.push_back(data);}
 	virtual bool eof() const {return false;}
 
+	virtual size_t write(T const* buffer, size_t count)
+	{
+		container_append(m_container, buffer, count);
+		return count;
+	}
+
 private:
 	Container_T& m_container;
 };
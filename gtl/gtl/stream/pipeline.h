@@ -0,0 +1,273 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_STREAM_PIPELINE_H
+#define GTL_STREAM_PIPELINE_H
+
+#include <gtl/common.h>
+#include <type_traits>
+#include <utility>
+#include "stream.h"
+
+namespace gtl {
+
+//Statically composed pipelines, source | map(f) | filter(p) | sink.  Any
+//range is a source, and each stage wraps it in another range, so the
+//whole chain is one type the compiler can fuse into a single loop.
+//
+//A pipeline is a range itself, range_in_stream turns it into a virtual
+//Input_Stream where type erasure is wanted, and stream_range goes the
+//other way.
+
+template <class Func> struct Map_Stage
+{
+	Func func;
+};
+
+template <class Func> struct Filter_Stage
+{
+	Func func;
+};
+
+template <class Func> struct Sink_Stage
+{
+	Func func;
+};
+
+template <class T> struct Stream_Sink_Stage
+{
+	Output_Stream<T>* stream;
+};
+
+template <class Range_T, class Func> class Map_Range
+{
+public:
+	typedef typename std::decay<
+		decltype(std::declval<Func const&>()(std::declval<Range_T const&>().get()))
+	>::type value_type;
+	typedef value_type get_type;
+
+	Map_Range(Range_T const& range, Func const& func) : m_range(range), m_func(func) {}
+
+	get_type get() const {return m_func(m_range.get());}
+	void pop() {m_range.pop();}
+	bool empty() const {return m_range.empty();}
+
+private:
+	Range_T m_range;
+	Func m_func;
+};
+
+template <class Range_T, class Func,
+	bool By_Value = !std::is_reference<decltype(std::declval<Range_T const&>().get())>::value>
+class Filter_Range
+{
+public:
+	typedef typename std::decay<decltype(std::declval<Range_T const&>().get())>::type value_type;
+	typedef decltype(std::declval<Range_T const&>().get()) get_type;
+
+	Filter_Range(Range_T const& range, Func const& func) : m_range(range), m_func(func)
+	{
+		skip();
+	}
+
+	get_type get() const {return m_range.get();}
+
+	void pop()
+	{
+		m_range.pop();
+		skip();
+	}
+
+	bool empty() const {return m_range.empty();}
+
+private:
+	//Leaves the range at the next element passing the filter
+	void skip()
+	{
+		while(!m_range.empty() && !m_func(m_range.get()))
+		{
+			m_range.pop();
+		}
+	}
+
+	Range_T m_range;
+	Func m_func;
+};
+
+//Upstream computes its elements (a map, say), so each is kept from the
+//test for get rather than computed twice
+template <class Range_T, class Func> class Filter_Range<Range_T, Func, true>
+{
+public:
+	typedef typename std::decay<decltype(std::declval<Range_T const&>().get())>::type value_type;
+	typedef value_type const& get_type;
+
+	Filter_Range(Range_T const& range, Func const& func) : m_range(range), m_func(func), m_value()
+	{
+		skip();
+	}
+
+	get_type get() const {return m_value;}
+
+	void pop()
+	{
+		m_range.pop();
+		skip();
+	}
+
+	bool empty() const {return m_range.empty();}
+
+private:
+	void skip()
+	{
+		for(; !m_range.empty(); m_range.pop())
+		{
+			m_value = m_range.get();
+			if(m_func(m_value))
+			{
+				break;
+			}
+		}
+	}
+
+	Range_T m_range;
+	Func m_func;
+	value_type m_value;
+};
+
+//Single pass range over a virtual stream, copies share the stream.
+//Elements are only taken from the stream once looked at, so a pipeline
+//that stops early leaves the rest in it.
+template <class T> class Stream_Range
+{
+public:
+	typedef T value_type;
+	typedef T const& get_type;
+
+	Stream_Range(Input_Stream<T>& stream) : m_stream(&stream), m_value(), m_loaded(false) {}
+
+	get_type get() const
+	{
+		if(!m_loaded)
+		{
+			m_value = m_stream->get();
+			m_loaded = true;
+		}
+		return m_value;
+	}
+
+	void pop()
+	{
+		if(!m_loaded)
+		{
+			m_stream->get();
+		}
+		m_loaded = false;
+	}
+
+	bool empty() const {return !m_loaded && m_stream->eof();}
+
+private:
+	Input_Stream<T>* m_stream;
+	mutable T m_value;
+	mutable bool m_loaded;
+};
+
+template <class Container_T> struct Container_Sink
+{
+	Container_T* container;
+
+	template <class T> void operator()(T const& value) const {container->push_back(value);}
+};
+
+template <class Func> Map_Stage<Func> map(Func const& func)
+{
+	Map_Stage<Func> stage = {func};
+	return stage;
+}
+
+template <class Func> Filter_Stage<Func> filter(Func const& func)
+{
+	Filter_Stage<Func> stage = {func};
+	return stage;
+}
+
+//Calls func on every element reaching the end of the pipeline
+template <class Func> Sink_Stage<Func> sink(Func const& func)
+{
+	Sink_Stage<Func> stage = {func};
+	return stage;
+}
+
+template <class Container_T> Sink_Stage<Container_Sink<Container_T>> to_container(Container_T& container)
+{
+	Container_Sink<Container_T> func = {&container};
+	return sink(func);
+}
+
+//Puts elements until the stream hits eof
+template <class T> Stream_Sink_Stage<T> to_stream(Output_Stream<T>& stream)
+{
+	Stream_Sink_Stage<T> stage = {&stream};
+	return stage;
+}
+
+template <class T> Stream_Range<T> stream_range(Input_Stream<T>& stream)
+{
+	return Stream_Range<T>(stream);
+}
+
+template <class Range_T, class Func>
+Map_Range<Range_T, Func> operator|(Range_T const& range, Map_Stage<Func> const& stage)
+{
+	return Map_Range<Range_T, Func>(range, stage.func);
+}
+
+template <class Range_T, class Func>
+Filter_Range<Range_T, Func> operator|(Range_T const& range, Filter_Stage<Func> const& stage)
+{
+	return Filter_Range<Range_T, Func>(range, stage.func);
+}
+
+//Runs the pipeline, returns the number of elements sunk
+template <class Range_T, class Func>
+size_t operator|(Range_T range, Sink_Stage<Func> const& stage)
+{
+	Func func(stage.func);
+	size_t count = 0;
+	for(; !range.empty(); range.pop(), ++count)
+	{
+		func(range.get());
+	}
+	return count;
+}
+
+template <class Range_T, class T>
+size_t operator|(Range_T range, Stream_Sink_Stage<T> const& stage)
+{
+	size_t count = 0;
+	for(; !range.empty() && !stage.stream->eof(); range.pop(), ++count)
+	{
+		stage.stream->put(range.get());
+	}
+	return count;
+}
+
+} //ns
+
+#endif
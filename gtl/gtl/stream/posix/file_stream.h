@@ -0,0 +1,304 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_STREAM_POSIX_FILE_STREAM_H
+#define GTL_STREAM_POSIX_FILE_STREAM_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/stream/stream.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace gtl {
+
+//Byte streams over POSIX file descriptors, going through one large buffer.
+//Failed reads and writes show up as eof, with failed() telling them apart.
+
+class File_Input_Stream : public Input_Stream<char>, private Noncopyable
+{
+public:
+	File_Input_Stream(Context const* context, size_t buffer_size = 64 * 1024) :
+		m_context(context),
+		m_buffer_size(std::max(buffer_size, size_t(1))),
+		m_buffer(static_cast<char*>(context->allocator->allocate(m_buffer_size))),
+		m_fd(-1),
+		m_pos(0),
+		m_end(0),
+		m_done(true),
+		m_failed(false)
+	{
+	}
+
+	~File_Input_Stream()
+	{
+		close();
+		m_context->allocator->deallocate(m_buffer, m_buffer_size, Allocator::default_alignment);
+	}
+
+	bool open(char const* path)
+	{
+		close();
+
+		m_fd = ::open(path, O_RDONLY);
+		m_failed = m_fd < 0;
+		m_done = m_failed;
+		return !m_failed;
+	}
+
+	void close()
+	{
+		if(m_fd >= 0)
+		{
+			::close(m_fd);
+		}
+
+		m_fd = -1;
+		m_pos = m_end = 0;
+		m_done = true;
+		m_failed = false;
+	}
+
+	bool is_open() const {return m_fd >= 0;}
+	bool failed() const {return m_failed;}
+
+	virtual char get() override
+	{
+		if(m_pos == m_end)
+		{
+			fill();
+		}
+
+		GTL_ASSERT(m_pos != m_end);
+		return m_buffer[m_pos++];
+	}
+
+	virtual bool eof() const override
+	{
+		return m_pos == m_end && !fill();
+	}
+
+	//Whatever is buffered goes first, large remainders skip the buffer
+	virtual size_t read(char* buffer, size_t count) override
+	{
+		size_t n = std::min(count, m_end - m_pos);
+		std::memcpy(buffer, m_buffer + m_pos, n);
+		m_pos += n;
+
+		while(n < count && !m_done)
+		{
+			if(count - n >= m_buffer_size)
+			{
+				n += read_some(buffer + n, count - n);
+			}
+			else if(fill())
+			{
+				size_t chunk = std::min(count - n, m_end - m_pos);
+				std::memcpy(buffer + n, m_buffer + m_pos, chunk);
+				m_pos += chunk;
+				n += chunk;
+			}
+		}
+
+		return n;
+	}
+
+private:
+	//Refills an empty buffer, false at the end of the file
+	bool fill() const
+	{
+		GTL_ASSERT(m_pos == m_end);
+
+		m_pos = m_end = 0;
+		while(!m_done && m_end == 0)
+		{
+			m_end = read_some(m_buffer, m_buffer_size);
+		}
+
+		return m_end != 0;
+	}
+
+	size_t read_some(char* buffer, size_t count) const
+	{
+		ssize_t result;
+		do
+		{
+			result = ::read(m_fd, buffer, count);
+		} while(result < 0 && errno == EINTR);
+
+		if(result <= 0)
+		{
+			m_failed = result < 0;
+			m_done = true;
+			return 0;
+		}
+
+		return size_t(result);
+	}
+
+private:
+	Context const* m_context;
+	size_t m_buffer_size;
+	char* m_buffer;
+	int m_fd;
+	mutable size_t m_pos;
+	mutable size_t m_end;
+	mutable bool m_done;
+	mutable bool m_failed;
+};
+
+class File_Output_Stream : public Output_Stream<char>, private Noncopyable
+{
+public:
+	File_Output_Stream(Context const* context, size_t buffer_size = 64 * 1024) :
+		m_context(context),
+		m_buffer_size(std::max(buffer_size, size_t(1))),
+		m_buffer(static_cast<char*>(context->allocator->allocate(m_buffer_size))),
+		m_fd(-1),
+		m_pos(0),
+		m_failed(false)
+	{
+	}
+
+	~File_Output_Stream()
+	{
+		close();
+		m_context->allocator->deallocate(m_buffer, m_buffer_size, Allocator::default_alignment);
+	}
+
+	//Truncates the file unless appending
+	bool open(char const* path, bool append = false)
+	{
+		close();
+
+		m_fd = ::open(path, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+		m_failed = m_fd < 0;
+		return !m_failed;
+	}
+
+	//Flushes first, returns false if anything failed to reach the file
+	bool close()
+	{
+		bool ok = true;
+		if(m_fd >= 0)
+		{
+			ok = flush();
+			ok = ::close(m_fd) == 0 && ok;
+		}
+
+		m_fd = -1;
+		m_pos = 0;
+		m_failed = false;
+		return ok;
+	}
+
+	bool is_open() const {return m_fd >= 0;}
+	bool failed() const {return m_failed;}
+
+	virtual void put(char data) override
+	{
+		GTL_ASSERT(!eof());
+
+		m_buffer[m_pos++] = data;
+		if(m_pos == m_buffer_size)
+		{
+			flush();
+		}
+	}
+
+	virtual bool eof() const override {return m_fd < 0 || m_failed;}
+
+	virtual size_t write(char const* buffer, size_t count) override
+	{
+		if(eof() || count == 0)
+		{
+			return 0;
+		}
+
+		if(m_pos + count < m_buffer_size)
+		{
+			std::memcpy(m_buffer + m_pos, buffer, count);
+			m_pos += count;
+			return count;
+		}
+
+		//Doesn't fit, send what's pending first
+		if(!flush())
+		{
+			return 0;
+		}
+
+		//Blocks of a buffer or more go straight out, smaller ones start the
+		//next buffer
+		if(count >= m_buffer_size)
+		{
+			return write_all(buffer, count);
+		}
+
+		std::memcpy(m_buffer, buffer, count);
+		m_pos = count;
+		return count;
+	}
+
+	bool flush()
+	{
+		size_t pending = m_pos;
+		m_pos = 0;
+		return !m_failed && write_all(m_buffer, pending) == pending;
+	}
+
+private:
+	size_t write_all(char const* buffer, size_t count)
+	{
+		size_t n = 0;
+		while(n < count)
+		{
+			ssize_t result = ::write(m_fd, buffer + n, count - n);
+			if(result < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+
+				m_failed = true;
+				break;
+			}
+
+			n += size_t(result);
+		}
+
+		return n;
+	}
+
+private:
+	Context const* m_context;
+	size_t m_buffer_size;
+	char* m_buffer;
+	int m_fd;
+	size_t m_pos;
+	bool m_failed;
+};
+
+} //ns
+
+#endif
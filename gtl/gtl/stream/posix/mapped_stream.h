@@ -0,0 +1,140 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_STREAM_POSIX_MAPPED_STREAM_H
+#define GTL_STREAM_POSIX_MAPPED_STREAM_H
+
+#include <gtl/common.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/stream/stream.h>
+#include <gtl/string/char_range.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace gtl {
+
+//Maps a whole file read only.  range() hands out the unread part as a
+//Char_Const_Range for the string and range algorithms to run over in place,
+//the stream interface reads from the same position.
+class Mapped_Input_Stream : public Input_Stream<char>, private Noncopyable
+{
+public:
+	Mapped_Input_Stream() : m_map(0), m_size(0), m_pos(0) {}
+
+	~Mapped_Input_Stream()
+	{
+		close();
+	}
+
+	bool open(char const* path)
+	{
+		close();
+
+		int fd = ::open(path, O_RDONLY);
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		struct stat info;
+		bool ok = fstat(fd, &info) == 0;
+		if(ok && info.st_size > 0)
+		{
+			void* map = mmap(0, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if(map == MAP_FAILED)
+			{
+				ok = false;
+			}
+			else
+			{
+				madvise(map, size_t(info.st_size), MADV_SEQUENTIAL);
+				m_map = static_cast<char const*>(map);
+				m_size = size_t(info.st_size);
+			}
+		}
+
+		//The mapping holds on to the file by itself
+		::close(fd);
+		return ok;
+	}
+
+	void close()
+	{
+		if(m_map)
+		{
+			munmap(const_cast<char*>(m_map), m_size);
+		}
+
+		m_map = 0;
+		m_size = m_pos = 0;
+	}
+
+	//The whole file
+	string::Char_Const_Range all() const
+	{
+		return string::Char_Const_Range(m_map, m_size);
+	}
+
+	//What's left to read
+	string::Char_Const_Range range() const
+	{
+		return string::Char_Const_Range(m_map + m_pos, m_size - m_pos);
+	}
+
+	size_t size() const {return m_size;}
+
+	//Moves the read position, e.g. past what was consumed through range()
+	void seek(size_t pos)
+	{
+		m_pos = std::min(pos, m_size);
+	}
+
+	size_t tell() const {return m_pos;}
+
+	virtual char get() override
+	{
+		GTL_ASSERT(!eof());
+		return m_map[m_pos++];
+	}
+
+	virtual bool eof() const override {return m_pos == m_size;}
+
+	virtual size_t read(char* buffer, size_t count) override
+	{
+		size_t n = std::min(count, m_size - m_pos);
+		if(n)
+		{
+			std::memcpy(buffer, m_map + m_pos, n);
+		}
+		m_pos += n;
+		return n;
+	}
+
+private:
+	char const* m_map;
+	size_t m_size;
+	size_t m_pos;
+};
+
+} //ns
+
+#endif
@@ -18,10 +18,95 @@
 #define GTL_STREAM_RANGE_ADAPTERS_H
 
 #include <gtl/common.h>
+#include <gtl/range/iterator_range.h>
+#include <type_traits>
+#include <cstring>
 #include "stream.h"
 
 namespace gtl {
 
+//Moves up to count elements from the front of range into buffer
+template <class T, class Range_T>
+size_t range_read(Range_T& range, T* buffer, size_t count)
+{
+	size_t n = 0;
+	for(; n < count && !range.empty(); range.pop())
+	{
+		buffer[n++] = range.get();
+	}
+	return n;
+}
+
+template <class T, class U>
+size_t range_read_aux(Iterator_Range<U*>& range, T* buffer, size_t count, std::true_type)
+{
+	size_t n = std::min(count, range.size());
+	if(n)
+	{
+		std::memcpy(buffer, range.begin(), sizeof(T) * n);
+	}
+	range = Iterator_Range<U*>(range.begin() + n, range.end());
+	return n;
+}
+
+template <class T, class U>
+size_t range_read_aux(Iterator_Range<U*>& range, T* buffer, size_t count, std::false_type)
+{
+	size_t n = std::min(count, range.size());
+	std::copy(range.begin(), range.begin() + n, buffer);
+	range = Iterator_Range<U*>(range.begin() + n, range.end());
+	return n;
+}
+
+//Contiguous ranges of T are copied in one go
+template <class T, class U>
+size_t range_read(Iterator_Range<U*>& range, T* buffer, size_t count)
+{
+	return range_read_aux(range, buffer, count, typename std::integral_constant<bool,
+		std::is_same<typename std::remove_const<U>::type, T>::value &&
+		std::has_trivial_copy_constructor<T>::value>::type());
+}
+
+//Sets up to count elements at the front of range from buffer
+template <class T, class Range_T>
+size_t range_write(Range_T& range, T const* buffer, size_t count)
+{
+	size_t n = 0;
+	for(; n < count && !range.empty(); range.pop())
+	{
+		range.set(buffer[n++]);
+	}
+	return n;
+}
+
+template <class T>
+size_t range_write_aux(Iterator_Range<T*>& range, T const* buffer, size_t count, std::true_type)
+{
+	size_t n = std::min(count, range.size());
+	if(n)
+	{
+		std::memcpy(range.begin(), buffer, sizeof(T) * n);
+	}
+	range = Iterator_Range<T*>(range.begin() + n, range.end());
+	return n;
+}
+
+template <class T>
+size_t range_write_aux(Iterator_Range<T*>& range, T const* buffer, size_t count, std::false_type)
+{
+	size_t n = std::min(count, range.size());
+	std::copy(buffer, buffer + n, range.begin());
+	range = Iterator_Range<T*>(range.begin() + n, range.end());
+	return n;
+}
+
+template <class T>
+size_t range_write(Iterator_Range<T*>& range, T const* buffer, size_t count)
+{
+	return range_write_aux(range, buffer, count,
+		typename std::has_trivial_copy_constructor<T>::type());
+}
+
 template <class T, class Range_T> class Range_Input_Stream :
 	public Input_Stream<T>
 {
@@ -37,6 +122,11 @@ public:
 
 	virtual bool eof() const {return m_range.empty();}
 
+	virtual size_t read(T* buffer, size_t count)
+	{
+		return range_read(m_range, buffer, count);
+	}
+
 private:
 	Range_T m_range;
 };
@@ -55,6 +145,11 @@ public:
 
 	virtual bool eof() const {return m_range.empty();}
 
+	virtual size_t write(T const* buffer, size_t count)
+	{
+		return range_write(m_range, buffer, count);
+	}
+
 private:
 	Range_T m_range;
 };
@@ -0,0 +1,200 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_STREAM_READAHEAD_STREAM_H
+#define GTL_STREAM_READAHEAD_STREAM_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/containers/vector.h>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "stream.h"
+
+namespace gtl {
+
+//Reads ahead of the consumer on a background thread, filling up to
+//buffer_count - 1 blocks of buffer_size elements while the current one is
+//drained.  The source belongs to the background thread from construction
+//until this is destroyed, and must not throw.
+template <class T> class Async_Readahead_Stream : public Input_Stream<T>, private Noncopyable
+{
+public:
+	Async_Readahead_Stream(Context const* context, Input_Stream<T>& source,
+		size_t buffer_size = 16 * 1024, size_t buffer_count = 2) :
+		m_source(source),
+		m_buffer_size(std::max(buffer_size, size_t(1))),
+		m_buffer_count(std::max(buffer_count, size_t(2))),
+		m_buffers(context, m_buffer_size * m_buffer_count),
+		m_filled(context, m_buffer_count),
+		m_ready(0),
+		m_produce(0),
+		m_done(false),
+		m_stop(false),
+		m_consume(0),
+		m_holding(false),
+		m_pos(0),
+		m_end(0)
+	{
+		m_thread = std::thread([this](){this->produce();});
+	}
+
+	~Async_Readahead_Stream()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_stop = true;
+		}
+
+		m_space.notify_one();
+		m_thread.join();
+	}
+
+	virtual T get() override
+	{
+		if(m_pos == m_end)
+		{
+			next();
+		}
+
+		GTL_ASSERT(m_pos != m_end);
+		return m_buffers[m_consume * m_buffer_size + m_pos++];
+	}
+
+	virtual bool eof() const override
+	{
+		return m_pos == m_end && !next();
+	}
+
+	virtual size_t read(T* buffer, size_t count) override
+	{
+		size_t n = 0;
+		while(n < count && !eof())
+		{
+			size_t chunk = std::min(count - n, m_end - m_pos);
+			T const* block = &m_buffers[m_consume * m_buffer_size + m_pos];
+			std::copy(block, block + chunk, buffer + n);
+			m_pos += chunk;
+			n += chunk;
+		}
+
+		return n;
+	}
+
+private:
+	void produce()
+	{
+		size_t const count = m_buffer_count;
+
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				while(m_ready == count && !m_stop)
+				{
+					m_space.wait(lock);
+				}
+
+				if(m_stop)
+				{
+					break;
+				}
+			}
+
+			//Only the consumer's buffers are counted in m_ready, this one is ours
+			size_t n = m_source.read(&m_buffers[m_produce * m_buffer_size], m_buffer_size);
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				if(n > 0)
+				{
+					m_filled[m_produce] = n;
+					m_produce = (m_produce + 1) % count;
+					++m_ready;
+				}
+
+				m_done = n < m_buffer_size;
+			}
+
+			m_data.notify_one();
+			if(n < m_buffer_size)
+			{
+				break;
+			}
+		}
+	}
+
+	//Hands the drained buffer back and waits for the next one, false at
+	//the end of the source
+	bool next() const
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		if(m_holding)
+		{
+			m_holding = false;
+			m_consume = (m_consume + 1) % m_buffer_count;
+			--m_ready;
+			m_space.notify_one();
+		}
+
+		while(m_ready == 0 && !m_done)
+		{
+			m_data.wait(lock);
+		}
+
+		if(m_ready == 0)
+		{
+			return false;
+		}
+
+		m_holding = true;
+		m_pos = 0;
+		m_end = m_filled[m_consume];
+		return true;
+	}
+
+private:
+	Input_Stream<T>& m_source;
+	size_t m_buffer_size;
+	size_t m_buffer_count;
+	Vector<T> m_buffers;
+	Vector<size_t> m_filled;
+	std::thread m_thread;
+
+	//Shared, under m_lock
+	mutable std::mutex m_lock;
+	mutable std::condition_variable m_data;
+	mutable std::condition_variable m_space;
+	mutable size_t m_ready;
+	size_t m_produce;
+	bool m_done;
+	bool m_stop;
+
+	//Consumer side
+	mutable size_t m_consume;
+	mutable bool m_holding;
+	mutable size_t m_pos;
+	mutable size_t m_end;
+};
+
+} //ns
+
+#endif
@@ -0,0 +1,348 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GTL_STREAM_SPSC_RING_H
+#define GTL_STREAM_SPSC_RING_H
+
+#include <gtl/common.h>
+#include <gtl/context.h>
+#include <gtl/noncopyable.h>
+#include <gtl/debug.h>
+#include <gtl/containers/vector.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "stream.h"
+
+namespace gtl {
+
+//Bounded ring between one producer thread and one consumer thread, without
+//locks.  Each side keeps its own index and a cached copy of the other's,
+//only publishing its index every batch elements or before it waits, so the
+//shared lines are touched once per batch rather than per element.
+//
+//The producer must publish or close for the consumer to see the tail of
+//what it pushed.  Waiting spins a little, then yields.
+template <class T> class Spsc_Ring : private Noncopyable
+{
+public:
+	class Producer;
+	class Consumer;
+
+	//capacity is rounded up to a power of two
+	Spsc_Ring(Context const* context, size_t capacity, size_t batch = 32) :
+		m_mask(round_capacity(capacity) - 1),
+		m_batch(std::max(std::min(batch, (m_mask + 1) / 2), size_t(1))),
+		m_slots(context, m_mask + 1),
+		m_tail(0),
+		m_write(0),
+		m_published(0),
+		m_head_cache(0),
+		m_head(0),
+		m_read(0),
+		m_released(0),
+		m_tail_cache(0),
+		m_closed(false)
+	{
+	}
+
+	size_t capacity() const {return m_mask + 1;}
+
+	//Producer side
+
+	bool try_push(T const& value)
+	{
+		if(full())
+		{
+			publish();
+			refresh_head();
+			if(full())
+			{
+				return false;
+			}
+		}
+
+		push_unchecked(value);
+		return true;
+	}
+
+	void push(T const& value)
+	{
+		if(full())
+		{
+			wait_space();
+		}
+
+		push_unchecked(value);
+	}
+
+	//Pushes what fits without waiting, returns how many went in
+	size_t push_some(T const* buffer, size_t count)
+	{
+		if(full())
+		{
+			refresh_head();
+		}
+
+		size_t n = std::min(count, capacity() - (m_write - m_head_cache));
+		size_t first = std::min(n, capacity() - (m_write & m_mask));
+		std::copy(buffer, buffer + first, &m_slots[m_write & m_mask]);
+		std::copy(buffer + first, buffer + n, &m_slots[0]);
+		m_write += n;
+
+		if(m_write - m_published >= m_batch)
+		{
+			publish();
+		}
+		return n;
+	}
+
+	void publish()
+	{
+		m_published = m_write;
+		m_tail.store(m_write, std::memory_order_release);
+	}
+
+	//Publishes everything, the consumer sees the end once it's drained
+	void close()
+	{
+		publish();
+		m_closed.store(true, std::memory_order_release);
+	}
+
+	//Consumer side
+
+	bool try_pop(T& value)
+	{
+		if(m_read == m_tail_cache)
+		{
+			release();
+			if(!refresh_tail())
+			{
+				return false;
+			}
+		}
+
+		value = pop_unchecked();
+		return true;
+	}
+
+	//Blocks until there is something, false once closed and drained
+	bool wait()
+	{
+		if(m_read != m_tail_cache)
+		{
+			return true;
+		}
+
+		//Let the producer have the space back before waiting on it
+		release();
+		for(size_t spin = 0; ; ++spin)
+		{
+			//Read before the tail, so a close seen here covers the final tail
+			bool closed = m_closed.load(std::memory_order_acquire);
+			if(refresh_tail())
+			{
+				return true;
+			}
+
+			if(closed)
+			{
+				return false;
+			}
+
+			backoff(spin);
+		}
+	}
+
+	T pop()
+	{
+		bool ready = wait();
+		GTL_ASSERT(ready);
+		GTL_REF(ready);
+		return pop_unchecked();
+	}
+
+	//Pops what is already there without waiting, returns how many
+	size_t pop_some(T* buffer, size_t count)
+	{
+		if(m_read == m_tail_cache)
+		{
+			refresh_tail();
+		}
+
+		size_t n = std::min(count, m_tail_cache - m_read);
+		size_t first = std::min(n, capacity() - (m_read & m_mask));
+		T const* slots = &m_slots[0];
+		std::copy(slots + (m_read & m_mask), slots + (m_read & m_mask) + first, buffer);
+		std::copy(slots, slots + (n - first), buffer + first);
+		m_read += n;
+
+		if(m_read - m_released >= m_batch)
+		{
+			release();
+		}
+		return n;
+	}
+
+	void release()
+	{
+		m_released = m_read;
+		m_head.store(m_read, std::memory_order_release);
+	}
+
+private:
+	static size_t round_capacity(size_t capacity)
+	{
+		size_t result = 2;
+		while(result < capacity)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+
+	static void backoff(size_t spin)
+	{
+		if(spin > 64)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	bool full() const {return m_write - m_head_cache == capacity();}
+
+	void refresh_head()
+	{
+		m_head_cache = m_head.load(std::memory_order_acquire);
+	}
+
+	//True if there is something new to read
+	bool refresh_tail()
+	{
+		m_tail_cache = m_tail.load(std::memory_order_acquire);
+		return m_read != m_tail_cache;
+	}
+
+	void wait_space()
+	{
+		//The consumer might be waiting on what's pending
+		publish();
+		for(size_t spin = 0; refresh_head(), full(); ++spin)
+		{
+			backoff(spin);
+		}
+	}
+
+	void push_unchecked(T const& value)
+	{
+		m_slots[m_write & m_mask] = value;
+		if(++m_write - m_published >= m_batch)
+		{
+			publish();
+		}
+	}
+
+	T pop_unchecked()
+	{
+		T value = m_slots[m_read & m_mask];
+		if(++m_read - m_released >= m_batch)
+		{
+			release();
+		}
+		return value;
+	}
+
+private:
+	size_t m_mask;
+	size_t m_batch;
+	Vector<T> m_slots;
+	char m_padding0[64];
+
+	//Written by the producer
+	std::atomic<size_t> m_tail;
+	size_t m_write;
+	size_t m_published;
+	size_t m_head_cache;
+	char m_padding1[64];
+
+	//Written by the consumer
+	std::atomic<size_t> m_head;
+	size_t m_read;
+	size_t m_released;
+	size_t m_tail_cache;
+	char m_padding2[64];
+
+	std::atomic<bool> m_closed;
+};
+
+//Output_Stream face for the producer thread
+template <class T> class Spsc_Ring<T>::Producer : public Output_Stream<T>
+{
+public:
+	Producer(Spsc_Ring& ring) : m_ring(ring) {}
+
+	virtual void put(T data) override {m_ring.push(data);}
+	virtual bool eof() const override {return false;}
+
+	//Waits for space as needed, the whole block goes in
+	virtual size_t write(T const* buffer, size_t count) override
+	{
+		size_t n = m_ring.push_some(buffer, count);
+		while(n < count)
+		{
+			m_ring.wait_space();
+			n += m_ring.push_some(buffer + n, count - n);
+		}
+		return n;
+	}
+
+	void publish() {m_ring.publish();}
+	void close() {m_ring.close();}
+
+private:
+	Spsc_Ring& m_ring;
+};
+
+//Input_Stream face for the consumer thread.  eof waits for the producer,
+//and is only true once the ring is closed and drained.
+template <class T> class Spsc_Ring<T>::Consumer : public Input_Stream<T>
+{
+public:
+	Consumer(Spsc_Ring& ring) : m_ring(ring) {}
+
+	virtual T get() override {return m_ring.pop();}
+	virtual bool eof() const override {return !m_ring.wait();}
+
+	//Fills the whole block unless the ring is closed first
+	virtual size_t read(T* buffer, size_t count) override
+	{
+		size_t n = 0;
+		while(n < count && m_ring.wait())
+		{
+			n += m_ring.pop_some(buffer + n, count - n);
+		}
+		return n;
+	}
+
+private:
+	Spsc_Ring& m_ring;
+};
+
+} //ns
+
+#endif
@@ -27,6 +27,19 @@ public:
 	virtual T get() = 0;
 	virtual bool eof() const = 0;
 
+	//Reads up to count elements, fewer only at eof.  Returns how many
+	//were read.  Streams over contiguous data override this to copy
+	//whole blocks.
+	virtual size_t read(T* buffer, size_t count)
+	{
+		size_t n = 0;
+		for(; n < count && !eof(); ++n)
+		{
+			buffer[n] = get();
+		}
+		return n;
+	}
+
 protected:
 	virtual ~Input_Stream() {} 
 };
@@ -37,6 +50,18 @@ public:
 	virtual void put(T data) = 0;
 	virtual bool eof() const = 0;
 
+	//Writes up to count elements, fewer only at eof.  Returns how many
+	//were written.
+	virtual size_t write(T const* buffer, size_t count)
+	{
+		size_t n = 0;
+		for(; n < count && !eof(); ++n)
+		{
+			put(buffer[n]);
+		}
+		return n;
+	}
+
 protected:
 	virtual ~Output_Stream() {} 
 };
@@ -18,10 +18,16 @@
 #define GTL_STREAM_STREAM_ADAPTERS_H
 
 #include <gtl/common.h>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
 #include "stream.h"
 
 namespace gtl {
 
+//Element type of an output stream, never defined
+template <class T> T output_stream_value(Output_Stream<T> const*);
+
 template <class T, class Stream, class Func> class Adapter_Input_Stream :
 	public Input_Stream<T>
 {
@@ -36,6 +42,29 @@ public:
 
 	virtual bool eof() const override {return m_stream.eof();}
 
+	virtual size_t read(T* buffer, size_t count) override
+	{
+		typedef typename std::decay<decltype(std::declval<Stream&>().get())>::type source_type;
+		return read_aux(buffer, count, typename std::is_same<source_type, T>::type());
+	}
+
+private:
+	//Same element type, the block is mapped in place
+	size_t read_aux(T* buffer, size_t count, std::true_type)
+	{
+		size_t n = m_stream.read(buffer, count);
+		for(size_t i = 0; i < n; ++i)
+		{
+			buffer[i] = m_func(buffer[i]);
+		}
+		return n;
+	}
+
+	size_t read_aux(T* buffer, size_t count, std::false_type)
+	{
+		return Input_Stream<T>::read(buffer, count);
+	}
+
 private:
 	Stream& m_stream;
 	Func m_func;
@@ -55,6 +84,44 @@ public:
 
 	virtual bool eof() const override {return m_stream.eof();}
 
+	virtual size_t write(T const* buffer, size_t count) override
+	{
+		typedef decltype(output_stream_value(&m_stream)) target_type;
+		return write_aux<target_type>(buffer, count,
+			typename std::has_trivial_default_constructor<target_type>::type());
+	}
+
+private:
+	static size_t const block_size = 64;
+
+	//Mapped a block at a time through a local buffer
+	template <class U> size_t write_aux(T const* buffer, size_t count, std::true_type)
+	{
+		U block[block_size];
+		size_t done = 0;
+		while(done < count)
+		{
+			size_t n = std::min(count - done, size_t(block_size));
+			for(size_t i = 0; i < n; ++i)
+			{
+				block[i] = m_func(buffer[done + i]);
+			}
+
+			size_t written = m_stream.write(block, n);
+			done += written;
+			if(written < n)
+			{
+				break;
+			}
+		}
+		return done;
+	}
+
+	template <class U> size_t write_aux(T const* buffer, size_t count, std::false_type)
+	{
+		return Output_Stream<T>::write(buffer, count);
+	}
+
 private:
 	Stream& m_stream;
 	Func m_func;
@@ -80,6 +80,12 @@ public:
 		}
 	}
 
+	//Informational output, e.g. benchmark timings
+	void output(char const* string)
+	{
+		m_platform.output(string);
+	}
+
 private:
 	void fail(char const* file, unsigned int line)
 	{
@@ -25,6 +25,16 @@ namespace gtl {
 using std::true_type;
 using std::false_type;
 
+//Objects that may be moved to another address with memcpy, leaving nothing
+//to destroy at the old one.  Specialize for types that own their storage
+//through pointers to the heap only.
+template <class T> struct is_trivially_relocatable :
+	std::integral_constant<bool,
+		std::has_trivial_copy_constructor<T>::value &&
+		std::has_trivial_destructor<T>::value>
+{
+};
+
 } //namespace
 
 #endif
@@ -17,6 +17,10 @@
 #include "common.h"
 #include <gtl/context.h>
 #include <gtl/debug.h>
+#include <gtl/allocator/arena_allocator.h>
+#include <gtl/allocator/size_class_allocator.h>
+#include <gtl/containers/vector.h>
+#include <gtl/containers/list.h>
 #include <vector>
 #include <list>
 
@@ -79,4 +83,246 @@ bool test_allocator()
 	return true;
 }
 
+class Test_Aligned_Allocation : public Gtl_Test_Case
+{
+public:
+	struct Aligned
+	{
+		Aligned(int i) : i(i) {}
+		int i;
+	};
+
+	struct GTL_ALIGNAS(64) Wide
+	{
+		Wide(int i) : i(i) {}
+		int i;
+	};
+
+	template <class Alloc_T>
+	void test_aligned(Test_Context& tc, Alloc_T& alloc)
+	{
+		void* blocks[8];
+		for(size_t i = 0; i < 8; ++i)
+		{
+			size_t align = size_t(1) << (i + 2);
+			blocks[i] = alloc.allocate(24, align);
+			GTL_TEST_EQ(tc, reinterpret_cast<uintptr_t>(blocks[i]) % align, 0u);
+			memset(blocks[i], 0, 24);
+		}
+
+		for(size_t i = 0; i < 8; ++i)
+		{
+			alloc.deallocate(blocks[i], 24, size_t(1) << (i + 2));
+		}
+	}
+
+	virtual void run(Test_Context& tc)
+	{
+		test_aligned(tc, m_alloc);
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			Arena_Allocator arena(&m_alloc, 256);
+			test_aligned(tc, arena);
+
+			//Only the last allocation may grow in place
+			char* a = static_cast<char*>(arena.allocate(16));
+			char* b = static_cast<char*>(arena.allocate(16));
+			GTL_TEST_VERIFY(tc, !arena.try_expand(a, 16, 32));
+			GTL_TEST_VERIFY(tc, arena.try_expand(b, 16, 64));
+			GTL_TEST_VERIFY(tc, !arena.try_expand(b, 64, 4096));
+			GTL_TEST_EQ(tc, static_cast<char*>(arena.allocate(1)), b + 64);
+		}
+
+		{
+			Size_Class_Allocator alloc(&m_alloc);
+			test_aligned(tc, alloc);
+
+			void* p = alloc.allocate(100);
+			alloc.deallocate(p, 100, Allocator::default_alignment);
+			GTL_TEST_EQ(tc, alloc.allocate(97), p);
+			alloc.deallocate(p);
+
+			Context context(&alloc);
+			Aligned* x = context.create<Aligned>(emplace(5));
+			GTL_TEST_EQ(tc, x->i, 5);
+			context.destroy_created(x);
+		}
+
+		{
+			//Over-aligned objects come from create, new (context) only
+			//gives the default alignment
+			Size_Class_Allocator alloc(&m_alloc);
+			Context contexts[2] = {Context(&m_alloc), Context(&alloc)};
+			for(size_t i = 0; i < 2; ++i)
+			{
+				Wide* wide = contexts[i].create<Wide>(emplace(7));
+				GTL_TEST_EQ(tc, reinterpret_cast<uintptr_t>(wide) % 64, 0u);
+				GTL_TEST_EQ(tc, wide->i, 7);
+				contexts[i].destroy_created(wide);
+
+				Aligned* placed = new (&contexts[i]) Aligned(8);
+				GTL_TEST_EQ(tc, placed->i, 8);
+				contexts[i].destroy(placed);
+			}
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Arena_Allocator : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			Arena_Allocator arena(&m_alloc, 256);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+			char* a = static_cast<char*>(arena.allocate(1));
+			char* b = static_cast<char*>(arena.allocate(16));
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 1);
+			GTL_TEST_EQ(tc, reinterpret_cast<uintptr_t>(b) % Allocator::default_alignment, 0u);
+			GTL_TEST_VERIFY(tc, b > a);
+
+			Arena_Allocator::Mark mark = arena.mark();
+			char* c = static_cast<char*>(arena.allocate(200));
+			char* d = static_cast<char*>(arena.allocate(200));
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 2);
+
+			//Oversized requests get a dedicated block
+			arena.allocate(1000);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 3);
+
+			arena.rewind(mark);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 2);
+			GTL_TEST_EQ(tc, static_cast<char*>(arena.allocate(200)), c);
+			GTL_TEST_EQ(tc, static_cast<char*>(arena.allocate(200)), d);
+
+			arena.reset();
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 2);
+			GTL_TEST_EQ(tc, static_cast<char*>(arena.allocate(1)), a);
+
+			arena.release();
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+		}
+
+		{
+			Arena_Allocator arena(&m_alloc, 1024);
+			Context context(&arena);
+
+			{
+				Arena_Scope scope(arena);
+				Vector<int> vec(&context);
+				List<int> list(&context);
+				for(int i = 0; i < 100; ++i)
+				{
+					vec.push_back(i);
+					list.push_back(i);
+				}
+
+				GTL_TEST_EQ(tc, vec[99], 99);
+				GTL_TEST_EQ(tc, list.back(), 99);
+			}
+
+			//Everything came back with the scope, the blocks are retained
+			GTL_TEST_EQ(tc, arena.mark().block, (void*) 0);
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Size_Class_Allocator : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		typedef Size_Class_Allocator alloc_type;
+
+		for(size_t size = 1; size <= alloc_type::max_size; ++size)
+		{
+			size_t index = alloc_type::class_of(size);
+			GTL_TEST_VERIFY(tc, index < alloc_type::class_count);
+			GTL_TEST_VERIFY(tc, alloc_type::class_size(index) >= size);
+			GTL_TEST_VERIFY(tc, index == 0 || alloc_type::class_size(index - 1) < size);
+		}
+		GTL_TEST_EQ(tc, alloc_type::class_size(alloc_type::class_count - 1), size_t(alloc_type::max_size));
+
+		{
+			//Regions are only acquired on demand
+			alloc_type alloc(&m_alloc, 4);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+			static size_t const count = 300;
+			char* blocks[count];
+			for(size_t i = 0; i < count; ++i)
+			{
+				size_t size = (i * 37) % 3000 + 1;
+				blocks[i] = static_cast<char*>(alloc.allocate(size));
+				GTL_TEST_EQ(tc, reinterpret_cast<uintptr_t>(blocks[i]) % Allocator::default_alignment, 0u);
+				memset(blocks[i], static_cast<int>(i), size);
+			}
+
+			for(size_t i = 0; i < count; ++i)
+			{
+				size_t size = (i * 37) % 3000 + 1;
+				GTL_TEST_EQ(tc, blocks[i][size - 1], static_cast<char>(i));
+			}
+
+			//Free in a different order than allocated
+			for(size_t i = 0; i < count; i += 2)
+			{
+				alloc.deallocate(blocks[i]);
+			}
+
+			for(size_t i = 1; i < count; i += 2)
+			{
+				alloc.deallocate(blocks[i]);
+			}
+
+			//Only the chunk table, chunks and nothing oversized left
+			int chunks = m_alloc.outstanding() - 1;
+			GTL_TEST_VERIFY(tc, chunks > 0);
+
+			//Growth within the class of the block
+			void* p = alloc.allocate(100);
+			GTL_TEST_VERIFY(tc, alloc.try_expand(p, 100, 112));
+			GTL_TEST_VERIFY(tc, !alloc.try_expand(p, 112, 113));
+			alloc.deallocate(p, 112, Allocator::default_alignment);
+
+			Context context(&alloc);
+			{
+				Vector<int> vec(&context);
+				List<int> list(&context);
+				for(int i = 0; i < 1000; ++i)
+				{
+					vec.push_back(i);
+					list.push_back(i);
+				}
+
+				GTL_TEST_EQ(tc, vec[999], 999);
+				GTL_TEST_EQ(tc, list.size(), 1000u);
+			}
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+void test_allocator(Test_Platform& platform)
+{
+	Test_Suite suite("allocator", platform);
+
+	Test_Aligned_Allocation test_aligned;
+	suite.run("aligned", test_aligned);
+
+	Test_Arena_Allocator test_arena;
+	suite.run("arena", test_arena);
+
+	Test_Size_Class_Allocator test_size_class;
+	suite.run("size class", test_size_class);
+}
+
 } //gtl
@@ -0,0 +1,468 @@
+/**
+ * Copyright 2013 Kevin Lin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "common.h"
+#include <gtl/allocator/arena_allocator.h>
+#include <gtl/containers/list.h>
+#include <gtl/containers/unrolled_list.h>
+#include <gtl/containers/vector.h>
+#include <gtl/containers/registry.h>
+#include <gtl/containers/dense_registry.h>
+#include <gtl/containers/radix_registry.h>
+#include <gtl/stream.h>
+#include <gtl/stream/readahead_stream.h>
+#include <gtl/stream/spsc_ring.h>
+#include <gtl/string/cstr.h>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+//Timings only, not part of run_tests.  Results are printed, never checked.
+
+namespace gtl {
+
+namespace {
+
+//Milliseconds taken by func
+template <class Func> double time_ms(Func func)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	func();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count();
+}
+
+template <class Range_T> int64_t sum_range(Range_T range)
+{
+	int64_t sum = 0;
+	for(; !range.empty(); range.pop())
+	{
+		sum += range.get();
+	}
+	return sum;
+}
+
+//Random paths of depth steps, with the first shared levels drawn from
+//shared_width values and the rest from width
+void make_paths(Vector<uint>& steps, size_t paths, size_t depth,
+	uint seed, size_t shared, uint shared_width, uint width)
+{
+	for(size_t i = 0; i < paths * depth; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		steps.push_back(i % depth < shared ? (seed >> 16) % shared_width : (seed >> 16) % width);
+	}
+}
+
+void make_ints(Vector<int>& ints, size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		ints.push_back(int(i));
+	}
+}
+
+//Same as an int, but has to be copied element by element
+struct Copied_Int
+{
+	Copied_Int(int v) : value(v) {}
+	Copied_Int(Copied_Int const& x) : value(x.value) {}
+
+	int value;
+};
+
+}
+
+class Benchmark_Vector_Growth : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		size_t const count = 1 << 20;
+		double copy = time_ms([&]{push_back<Copied_Int>(&m_context, count);});
+		double relocate = time_ms([&]{push_back<int>(&m_context, count);});
+
+		Arena_Allocator arena(&m_alloc, sizeof(int) * count * 2);
+		Context context(&arena);
+		double in_place = time_ms([&]{push_back<int>(&context, count);});
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Vector growth, %u push_backs: copy %.2fms, relocate %.2fms, in place %.2fms",
+			unsigned(count), copy, relocate, in_place);
+		tc.output(buffer);
+	}
+
+private:
+	template <class T>
+	static void push_back(Context const* context, size_t count)
+	{
+		Vector<T> array(context);
+		for(size_t i = 0; i < count; ++i)
+		{
+			array.push_back(T(int(i)));
+		}
+	}
+};
+
+class Benchmark_Unrolled_List : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		size_t const count = 1 << 20;
+		List<int> list(&m_context);
+		Unrolled_List<int> unrolled(&m_context);
+		Vector<int> array(&m_context);
+		for(size_t i = 0; i < count; ++i)
+		{
+			list.push_back(int(i));
+			unrolled.push_back(int(i));
+			array.push_back(int(i));
+		}
+
+		int64_t sums[4];
+		double list_time = time_ms([&]{sums[0] = sum_range(list.all());});
+		double unrolled_time = time_ms([&]{sums[1] = sum_range(unrolled.all());});
+		double array_time = time_ms([&]{sums[2] = sum_range(array.all());});
+		double segment_time = time_ms([&]
+		{
+			sums[3] = 0;
+			for(Unrolled_List<int>::const_segment_range segments = unrolled.segments(); !segments.empty(); segments.pop())
+			{
+				Iterator_Range<int const*> segment = segments.get();
+				sums[3] = std::accumulate(segment.begin(), segment.end(), sums[3]);
+			}
+		});
+
+		GTL_TEST_EQ(tc, sums[1], sums[0]);
+		GTL_TEST_EQ(tc, sums[2], sums[0]);
+		GTL_TEST_EQ(tc, sums[3], sums[0]);
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Iterating %u ints: list %.2fms, unrolled list %.2fms (%.2fms by segment), vector %.2fms",
+			unsigned(count), list_time, unrolled_time, segment_time, array_time);
+		tc.output(buffer);
+	}
+};
+
+class Benchmark_Dense_Registry : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+
+		//Deep paths over a few values
+		static size_t const paths = 1 << 14;
+		static size_t const depth = 12;
+		Vector<uint> steps(&m_context);
+		make_paths(steps, paths, depth, 1, 0, 1, 6);
+
+		Node<int> tree(&m_context);
+		Dense_Registry<int> dense(&m_context);
+		for(size_t i = 0; i < paths; ++i)
+		{
+			auto path = steps.all().slice(i * depth, (i + 1) * depth);
+			tree.get_path(path)->data() = int(i);
+			dense.data(dense.get_path(path)) = int(i);
+		}
+
+		int64_t tree_sum = 0;
+		int64_t dense_sum = 0;
+		double tree_time = time_ms([&]
+		{
+			for(size_t i = 0; i < paths * 8; ++i)
+			{
+				tree_sum += tree.try_get_path(steps.all().slice(i % paths * depth, (i % paths + 1) * depth))->data();
+			}
+		});
+		double dense_time = time_ms([&]
+		{
+			for(size_t i = 0; i < paths * 8; ++i)
+			{
+				dense_sum += dense.data(dense.try_get_path(steps.all().slice(i % paths * depth, (i % paths + 1) * depth)));
+			}
+		});
+		GTL_TEST_EQ(tc, dense_sum, tree_sum);
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Registry, %u lookups of depth %u: nodes %.2fms, dense %.2fms",
+			unsigned(paths * 8), unsigned(depth), tree_time, dense_time);
+		tc.output(buffer);
+	}
+};
+
+class Benchmark_Radix_Registry : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+
+		//A few shared levels, then long unique suffixes
+		static size_t const paths = 1 << 12;
+		static size_t const depth = 16;
+		Vector<uint> steps(&m_context);
+		make_paths(steps, paths, depth, 7, 3, 4, 1000);
+
+		Node<int> tree(&m_context);
+		Radix_Registry<int> radix(&m_context);
+		for(size_t i = 0; i < paths; ++i)
+		{
+			auto path = steps.all().slice(i * depth, (i + 1) * depth);
+			tree.get_path(path)->data() = int(i);
+			radix.data(radix.get_path(path)) = int(i);
+		}
+
+		int64_t tree_sum = 0;
+		int64_t radix_sum = 0;
+		double tree_time = time_ms([&]
+		{
+			for(size_t i = 0; i < paths * 16; ++i)
+			{
+				tree_sum += tree.try_get_path(steps.all().slice(i % paths * depth, (i % paths + 1) * depth))->data();
+			}
+		});
+		double radix_time = time_ms([&]
+		{
+			for(size_t i = 0; i < paths * 16; ++i)
+			{
+				radix_sum += radix.data(radix.try_get_path(steps.all().slice(i % paths * depth, (i % paths + 1) * depth)));
+			}
+		});
+		GTL_TEST_EQ(tc, radix_sum, tree_sum);
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Registry, %u lookups of depth %u: nodes %.2fms, radix %.2fms",
+			unsigned(paths * 16), unsigned(depth), tree_time, radix_time);
+		tc.output(buffer);
+	}
+};
+
+class Benchmark_Stream_Blocks : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		static size_t const count = 1 << 20;
+		Vector<int> in(&m_context);
+		make_ints(in, count);
+
+		//Through the interfaces, as a generic consumer would
+		Vector<int> element_out(&m_context);
+		Vector<int> block_out(&m_context);
+		double element_time = time_ms([&]
+		{
+			auto in_stream = container_in_stream<int>(in);
+			auto out_stream = container_out_stream<int>(element_out);
+			Input_Stream<int>& input = in_stream;
+			Output_Stream<int>& output = out_stream;
+			while(!input.eof())
+			{
+				output.put(input.get());
+			}
+		});
+		double block_time = time_ms([&]
+		{
+			auto in_stream = container_in_stream<int>(in);
+			auto out_stream = container_out_stream<int>(block_out);
+			Input_Stream<int>& input = in_stream;
+			Output_Stream<int>& output = out_stream;
+			int buffer[4096];
+			while(size_t n = input.read(buffer, 4096))
+			{
+				output.write(buffer, n);
+			}
+		});
+		GTL_TEST_EQ(tc, block_out.size(), element_out.size());
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Stream, %u ints: per element %.2fms, blocks %.2fms",
+			unsigned(count), element_time, block_time);
+		tc.output(buffer);
+	}
+};
+
+class Benchmark_Pipeline : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		static size_t const count = 1 << 20;
+		Vector<int> in(&m_context);
+		make_ints(in, count);
+
+		auto add = [](int x) {return x + 1;};
+		auto scale = [](int x) {return x * 3;};
+		auto mask = [](int x) {return x & 0xffff;};
+
+		int64_t adapter_sum = 0;
+		double adapter_time = time_ms([&]
+		{
+			auto source = container_in_stream<int>(in);
+			auto first = adapter_in_stream<int>(source, add);
+			auto second = adapter_in_stream<int>(first, scale);
+			auto third = adapter_in_stream<int>(second, mask);
+			Input_Stream<int>& input = third;
+			while(!input.eof())
+			{
+				adapter_sum += input.get();
+			}
+		});
+
+		int64_t pipeline_sum = 0;
+		double pipeline_time = time_ms([&]
+		{
+			in.all() | map(add) | map(scale) | map(mask) | sink([&](int x) {pipeline_sum += x;});
+		});
+		GTL_TEST_EQ(tc, pipeline_sum, adapter_sum);
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Stream, 3 maps over %u ints: adapters %.2fms, pipeline %.2fms",
+			unsigned(count), adapter_time, pipeline_time);
+		tc.output(buffer);
+	}
+};
+
+//Takes a while for every block, like a disk would
+class Slow_Input_Stream : public Input_Stream<int>
+{
+public:
+	Slow_Input_Stream(Input_Stream<int>& source) : m_source(source) {}
+
+	virtual int get() override {return m_source.get();}
+	virtual bool eof() const override {return m_source.eof();}
+
+	virtual size_t read(int* buffer, size_t count) override
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		return m_source.read(buffer, count);
+	}
+
+private:
+	Input_Stream<int>& m_source;
+};
+
+class Benchmark_Readahead_Stream : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		static size_t const blocks = 20;
+		static size_t const block_size = 1024;
+		Vector<int> in(&m_context);
+		make_ints(in, blocks * block_size);
+
+		//Consumer also takes a while per block
+		auto consume = [&](Input_Stream<int>& stream) -> int64_t
+		{
+			int64_t sum = 0;
+			int buffer[block_size];
+			while(size_t n = stream.read(buffer, block_size))
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				sum = std::accumulate(buffer, buffer + n, sum);
+			}
+			return sum;
+		};
+
+		int64_t sums[2];
+		double direct_time = time_ms([&]
+		{
+			auto source = container_in_stream<int>(in);
+			Slow_Input_Stream direct(source);
+			sums[0] = consume(direct);
+		});
+		double ahead_time = time_ms([&]
+		{
+			auto source = container_in_stream<int>(in);
+			Slow_Input_Stream slow(source);
+			Async_Readahead_Stream<int> ahead(&m_context, slow, block_size, 2);
+			sums[1] = consume(ahead);
+		});
+		GTL_TEST_EQ(tc, sums[1], sums[0]);
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Stream, %u slow blocks: direct %.2fms, read ahead %.2fms",
+			unsigned(blocks), direct_time, ahead_time);
+		tc.output(buffer);
+	}
+};
+
+class Benchmark_Spsc_Ring : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		static size_t const count = 1 << 20;
+		Vector<int> in(&m_context);
+		make_ints(in, count);
+
+		Spsc_Ring<int> ring(&m_context, 1024);
+		int64_t sum = 0;
+		double ring_time = time_ms([&]
+		{
+			std::thread producer_thread([&]()
+			{
+				Spsc_Ring<int>::Producer producer(ring);
+				producer.write(in.begin(), in.size());
+				producer.close();
+			});
+
+			Spsc_Ring<int>::Consumer consumer(ring);
+			stream_range<int>(consumer) | sink([&](int x) {sum += x;});
+			producer_thread.join();
+		});
+		GTL_TEST_EQ(tc, sum, sum_range(in.all()));
+
+		char buffer[200];
+		string::snprintf(buffer, 200, "Stream, %u ints between threads: %.2fms",
+			unsigned(count), ring_time);
+		tc.output(buffer);
+	}
+};
+
+void test_benchmark(Test_Platform& platform)
+{
+	Test_Suite suite("benchmark", platform);
+
+	Benchmark_Vector_Growth benchmark_vector_growth;
+	suite.run("vector growth", benchmark_vector_growth);
+
+	Benchmark_Unrolled_List benchmark_unrolled_list;
+	suite.run("unrolled list", benchmark_unrolled_list);
+
+	Benchmark_Dense_Registry benchmark_dense_registry;
+	suite.run("dense registry", benchmark_dense_registry);
+
+	Benchmark_Radix_Registry benchmark_radix_registry;
+	suite.run("radix registry", benchmark_radix_registry);
+
+	Benchmark_Stream_Blocks benchmark_stream_blocks;
+	suite.run("stream blocks", benchmark_stream_blocks);
+
+	Benchmark_Pipeline benchmark_pipeline;
+	suite.run("pipeline", benchmark_pipeline);
+
+	Benchmark_Readahead_Stream benchmark_readahead_stream;
+	suite.run("readahead stream", benchmark_readahead_stream);
+
+	Benchmark_Spsc_Ring benchmark_spsc_ring;
+	suite.run("spsc ring", benchmark_spsc_ring);
+}
+
+} //ns
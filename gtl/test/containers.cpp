@@ -17,11 +17,30 @@
 
 #include "common.h"
 #include <gtl/containers/ilist.h>
+#include <gtl/containers/mpsc_queue.h>
+#include <gtl/containers/slist.h>
+#include <gtl/containers/atomic_slist.h>
 #include <gtl/containers/list.h>
+#include <gtl/containers/unrolled_list.h>
 #include <gtl/containers/vector.h>
+#include <gtl/containers/small_vector.h>
 #include <gtl/containers/registry.h>
+#include <gtl/containers/dense_registry.h>
+#include <gtl/containers/radix_registry.h>
+#include <gtl/containers/rcu_registry.h>
+#include <gtl/containers/registry_image.h>
+#include <gtl/containers/hash_map.h>
+#include <gtl/containers/lru_cache.h>
+#include <gtl/containers/flat_set.h>
+#include <gtl/containers/flat_map.h>
+#include <gtl/pool/pool.h>
 #include <gtl/containers/construct.h>
 #include <gtl/containers/emplace.h>
+#include <gtl/allocator/arena_allocator.h>
+#include <gtl/string/cstr.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 using namespace gtl;
 
@@ -198,6 +217,636 @@ public:
 	}
 };
 
+//Same as an int, but has to be copied element by element
+struct Copied_Int
+{
+	Copied_Int(int v) : value(v) {}
+	Copied_Int(Copied_Int const& x) : value(x.value) {}
+
+	int value;
+};
+
+class Test_Vector_Growth : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		GTL_TEST_VERIFY(tc, is_trivially_relocatable<int>::value);
+		GTL_TEST_VERIFY(tc, !is_trivially_relocatable<Copied_Int>::value);
+
+		{
+			//Only allocation in the arena, grows in place
+			Arena_Allocator arena(&m_alloc);
+			Context context(&arena);
+			Vector<int> array(&context);
+
+			array.push_back(0);
+			int* data = array.begin();
+			for(int i = 1; i < 1000; ++i)
+			{
+				array.push_back(i);
+			}
+
+			GTL_TEST_VERIFY(tc, array.begin() == data);
+			for(int i = 0; i < 1000; ++i)
+			{
+				GTL_TEST_EQ(tc, array[i], i);
+			}
+
+			int ref[5] = {-1, -1, -1, -1, -1};
+			array.insert(array.begin() + 1, ref, ref + 5);
+			array.resize(2000, -2);
+			GTL_TEST_VERIFY(tc, array.begin() == data);
+			GTL_TEST_EQ(tc, array[5], -1);
+			GTL_TEST_EQ(tc, array[6], 1);
+			GTL_TEST_EQ(tc, array[1005], -2);
+		}
+
+		test_relocation<int>(tc);
+		test_relocation<Copied_Int>(tc);
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+
+private:
+	static int value_of(int x) {return x;}
+	static int value_of(Copied_Int const& x) {return x.value;}
+
+	template <class T>
+	void test_relocation(Test_Context& tc)
+	{
+		Vector<T> array(&m_context);
+		for(int i = 0; i < 100; ++i)
+		{
+			//Refers to the buffer being replaced when the array is full
+			if(i % 2)
+			{
+				array.push_back(array[i - 1]);
+			}
+			else
+			{
+				array.push_back(T(i));
+			}
+		}
+
+		array.insert(array.begin() + 50, T(-1));
+		array.reserve(500);
+		GTL_TEST_EQ(tc, array.capacity(), 500u);
+		GTL_TEST_EQ(tc, array.size(), 101u);
+
+		for(int i = 0; i < 101; ++i)
+		{
+			int expected = i < 50 ? i & ~1 : (i == 50 ? -1 : (i - 1) & ~1);
+			GTL_TEST_EQ(tc, value_of(array[i]), expected);
+		}
+	}
+};
+
+//Can only be moved, exercises every move path of Vector
+struct Move_Only
+{
+	explicit Move_Only(int v) : value(v) {}
+	Move_Only(Move_Only&& x) : value(x.value) {x.value = -1;}
+
+	Move_Only& operator=(Move_Only&& x)
+	{
+		value = x.value;
+		x.value = -1;
+		return *this;
+	}
+
+	int value;
+
+private:
+	Move_Only(Move_Only const&);
+	Move_Only& operator=(Move_Only const&);
+};
+
+class Test_Vector_Move : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			Vector<Move_Only> array(&m_context);
+			for(int i = 0; i < 100; ++i)
+			{
+				array.push_back(Move_Only(i));
+			}
+
+			array.insert(array.begin(), Move_Only(-2));
+			array.emplace(array.begin() + 50, 1000);
+			array.erase(array.begin());
+			array.erase(array.begin() + 10, array.begin() + 20);
+			array.reserve(1000);
+
+			GTL_TEST_EQ(tc, array.size(), 91u);
+			GTL_TEST_EQ(tc, array[9].value, 9);
+			GTL_TEST_EQ(tc, array[10].value, 20);
+			GTL_TEST_EQ(tc, array[39].value, 1000);
+			GTL_TEST_EQ(tc, array[90].value, 99);
+
+			Vector<Move_Only> moved(std::move(array));
+			GTL_TEST_EQ(tc, moved.size(), 91u);
+			GTL_TEST_VERIFY(tc, array.empty());
+
+			array = std::move(moved);
+			GTL_TEST_EQ(tc, array.size(), 91u);
+			GTL_TEST_EQ(tc, array.capacity(), 1000u);
+			GTL_TEST_VERIFY(tc, moved.empty());
+		}
+
+		{
+			//Nested vectors are moved, never deep copied
+			Vector<Vector<int>> outer(&m_context);
+			Vector<int> copy(&m_context);
+			int* data[100];
+
+			for(int i = 0; i < 100; ++i)
+			{
+				Vector<int> inner(&m_context);
+				inner.push_back(i);
+				data[i] = inner.begin();
+
+				outer.push_back(std::move(inner));
+				GTL_TEST_VERIFY(tc, inner.empty());
+			}
+
+			int allocated = m_alloc.m_alloc;
+			outer.insert(outer.begin(), std::move(copy));
+			outer.reserve(500);
+			GTL_TEST_EQ(tc, m_alloc.m_alloc, allocated + 1);
+
+			for(int i = 0; i < 100; ++i)
+			{
+				GTL_TEST_VERIFY(tc, outer[i + 1].begin() == data[i]);
+				GTL_TEST_EQ(tc, outer[i + 1][0], i);
+			}
+
+			//Copies are still deep
+			Vector<Vector<int>> duplicate(outer);
+			GTL_TEST_VERIFY(tc, duplicate[1].begin() != data[0]);
+			GTL_TEST_EQ(tc, duplicate[100][0], 99);
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Small_Vector : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		typedef Small_Vector<Move_Only, 4> move_array;
+		typedef Small_Vector<int, 4> int_array;
+
+		{
+			int_array array(&m_context);
+			for(int i = 0; i < 4; ++i)
+			{
+				array.push_back(i);
+			}
+
+			GTL_TEST_EQ(tc, array.capacity(), 4u);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+			int sum = 0;
+			for(int_array::range all = array.all(); !all.empty(); all.pop())
+			{
+				sum += all.get();
+			}
+			GTL_TEST_EQ(tc, sum, 6);
+
+			//Spills on the fifth
+			array.func_emplace_back(emplace(4));
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 1);
+			GTL_TEST_EQ(tc, array[4], 4);
+
+			int_array copy(array);
+			GTL_TEST_EQ(tc, copy.size(), 5u);
+			GTL_TEST_EQ(tc, copy[2], 2);
+
+			copy.resize(2);
+			array = copy;
+			GTL_TEST_EQ(tc, array.size(), 2u);
+			GTL_TEST_EQ(tc, array[1], 1);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			move_array small(&m_context);
+			move_array large(&m_context);
+			small.push_back(Move_Only(1));
+			for(int i = 0; i < 10; ++i)
+			{
+				large.push_back(Move_Only(i));
+			}
+			Move_Only* large_data = large.begin();
+
+			//Heap buffers change hands, inline elements are moved
+			small.swap(large);
+			GTL_TEST_EQ(tc, small.size(), 10u);
+			GTL_TEST_VERIFY(tc, small.begin() == large_data);
+			GTL_TEST_EQ(tc, large.size(), 1u);
+			GTL_TEST_EQ(tc, large[0].value, 1);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 1);
+
+			move_array moved(std::move(large));
+			GTL_TEST_EQ(tc, moved[0].value, 1);
+			GTL_TEST_VERIFY(tc, large.empty());
+
+			moved = std::move(small);
+			GTL_TEST_EQ(tc, moved.size(), 10u);
+			GTL_TEST_VERIFY(tc, moved.begin() == large_data);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 1);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Moved, not deep copied, when the outer vector reallocates
+			Vector<int_array> outer(&m_context);
+			int* data[10];
+			for(int i = 0; i < 10; ++i)
+			{
+				int_array inner(&m_context);
+				inner.resize(5, i);
+				data[i] = inner.begin();
+				outer.push_back(std::move(inner));
+			}
+
+			int allocated = m_alloc.m_alloc;
+			outer.reserve(100);
+			GTL_TEST_EQ(tc, m_alloc.m_alloc, allocated + 1);
+			for(int i = 0; i < 10; ++i)
+			{
+				GTL_TEST_VERIFY(tc, outer[i].begin() == data[i]);
+				GTL_TEST_EQ(tc, outer[i][4], i);
+			}
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+//Puts every key in the same home slot
+struct Colliding_Hash
+{
+	size_t operator()(int) const {return 0;}
+};
+
+class Test_Hash_Map : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			typedef Hash_Map<int, int> map_type;
+			map_type map(&m_context);
+			GTL_TEST_VERIFY(tc, map.find(0) == 0);
+			GTL_TEST_VERIFY(tc, map.all().empty());
+
+			for(int i = 0; i < 1000; ++i)
+			{
+				GTL_TEST_VERIFY(tc, map.insert(i, i * 2).second);
+			}
+			GTL_TEST_VERIFY(tc, !map.insert(10, 0).second);
+			GTL_TEST_EQ(tc, map.size(), 1000u);
+
+			for(int i = 0; i < 1000; ++i)
+			{
+				GTL_TEST_EQ(tc, *map.find(i), i * 2);
+			}
+			GTL_TEST_VERIFY(tc, !map.contains(1000));
+
+			for(int i = 0; i < 1000; i += 2)
+			{
+				GTL_TEST_VERIFY(tc, map.erase(i));
+			}
+			GTL_TEST_VERIFY(tc, !map.erase(0));
+			GTL_TEST_EQ(tc, map.size(), 500u);
+
+			int sum = 0;
+			size_t count = 0;
+			for(map_type::const_range all = map.all(); !all.empty(); all.pop())
+			{
+				GTL_TEST_EQ(tc, all.get().key % 2, 1);
+				sum += all.get().value;
+				++count;
+			}
+			GTL_TEST_EQ(tc, count, 500u);
+			GTL_TEST_EQ(tc, sum, 500 * 1000);
+
+			count = 0;
+			for(auto first = truncate_range(map.all(), 10); !first.empty(); first.pop())
+			{
+				++count;
+			}
+			GTL_TEST_EQ(tc, count, 10u);
+
+			map[1] = 5;
+			map[2] += 3;
+			GTL_TEST_EQ(tc, *map.find(1), 5);
+			GTL_TEST_EQ(tc, *map.find(2), 3);
+
+			map.clear();
+			GTL_TEST_VERIFY(tc, map.empty());
+			GTL_TEST_VERIFY(tc, map.find(1) == 0);
+		}
+
+		{
+			//Long runs, erase has to shift every follower back
+			Hash_Map<int, int, Colliding_Hash> map(&m_context);
+			for(int i = 0; i < 20; ++i)
+			{
+				map.insert(i, i);
+			}
+
+			map.erase(0);
+			map.erase(10);
+			for(int i = 1; i < 20; ++i)
+			{
+				GTL_TEST_EQ(tc, map.contains(i), i != 10);
+			}
+		}
+
+		{
+			typedef Hash_Map<int, Vector<int>> map_type;
+			map_type map(&m_context);
+			map.reserve(100);
+			size_t capacity = map.capacity();
+
+			for(int i = 0; i < 100; ++i)
+			{
+				Vector<int>* value = map.func_emplace(i, emplace(&m_context)).first;
+				value->push_back(i);
+			}
+			GTL_TEST_EQ(tc, map.capacity(), capacity);
+
+			Vector<int> moved(&m_context);
+			moved.push_back(-1);
+			map.emplace(100, std::move(moved));
+			GTL_TEST_VERIFY(tc, moved.empty());
+
+			map_type other(std::move(map));
+			GTL_TEST_VERIFY(tc, map.empty());
+			for(int i = 0; i < 100; ++i)
+			{
+				GTL_TEST_EQ(tc, (*other.find(i))[0], i);
+			}
+			GTL_TEST_EQ(tc, (*other.find(100))[0], -1);
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Lru_Cache : public Gtl_Test_Case
+{
+public:
+	//Test_Allocator isn't thread safe, shards allocate concurrently
+	struct Locked_Allocator : public Allocator
+	{
+		using Allocator::allocate;
+		using Allocator::deallocate;
+
+		Locked_Allocator(Allocator* upstream) : upstream(upstream) {}
+
+		virtual void* allocate(size_t count)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return upstream->allocate(count);
+		}
+
+		virtual void deallocate(void* p)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			upstream->deallocate(p);
+		}
+
+		Allocator* upstream;
+		std::mutex lock;
+	};
+
+	struct Count_Evict
+	{
+		Count_Evict(int* count, int* last) : count(count), last(last) {}
+
+		void operator()(int const& key, Vector<int>&)
+		{
+			++*count;
+			*last = key;
+		}
+
+		int* count;
+		int* last;
+	};
+
+	virtual void run(Test_Context& tc)
+	{
+		{
+			int evicted = 0;
+			int last = -1;
+			Lru_Cache<int, Vector<int>, Count_Evict> cache(&m_context, 4, size_t(-1), Count_Evict(&evicted, &last));
+
+			for(int i = 0; i < 4; ++i)
+			{
+				GTL_TEST_VERIFY(tc, cache.func_emplace(i, emplace(&m_context)).second);
+				cache.peek(i)->push_back(i * 10);
+			}
+			GTL_TEST_VERIFY(tc, !cache.insert(2, Vector<int>(&m_context)).second);
+			GTL_TEST_EQ(tc, (*cache.peek(2))[0], 20);
+
+			//0 becomes the most recent, so 1 is the first to go
+			GTL_TEST_EQ(tc, (*cache.get(0))[0], 0);
+			cache.func_emplace(4, emplace(&m_context));
+			GTL_TEST_EQ(tc, cache.size(), 4u);
+			GTL_TEST_EQ(tc, evicted, 1);
+			GTL_TEST_EQ(tc, last, 1);
+			GTL_TEST_VERIFY(tc, !cache.get(1));
+
+			int order[] = {4, 0, 2, 3};
+			int i = 0;
+			for(auto r = cache.all(); !r.empty(); r.pop(), ++i)
+			{
+				GTL_TEST_EQ(tc, r.ref().key, order[i]);
+			}
+
+			GTL_TEST_VERIFY(tc, cache.erase(0));
+			GTL_TEST_VERIFY(tc, !cache.erase(0));
+			cache.set_limits(1);
+			GTL_TEST_EQ(tc, cache.size(), 1u);
+			GTL_TEST_EQ(tc, last, 2);
+			GTL_TEST_VERIFY(tc, cache.peek(4) != 0);
+			evicted = 0;
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Byte limit, the newest entry stays even when too large
+			Lru_Cache<int, int> cache(&m_context, 100, 10);
+			cache.insert(0, 0, 4);
+			cache.insert(1, 1, 4);
+			cache.insert(2, 2, 4);
+			GTL_TEST_EQ(tc, cache.size(), 2u);
+			GTL_TEST_EQ(tc, cache.bytes(), 8u);
+			GTL_TEST_VERIFY(tc, !cache.peek(0));
+
+			cache.insert(3, 3, 20);
+			GTL_TEST_EQ(tc, cache.size(), 1u);
+			GTL_TEST_EQ(tc, cache.bytes(), 20u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			static int const threads = 4;
+			static int const keys = 512;
+
+			Locked_Allocator locked(&m_alloc);
+			Context context(&locked);
+			Sharded_Lru_Cache<int, int> cache(&context, 8, 256);
+			std::atomic<bool> consistent(true);
+			std::thread workers[threads];
+			for(int t = 0; t < threads; ++t)
+			{
+				workers[t] = std::thread([&, t]()
+				{
+					for(int i = 0; i < 20000; ++i)
+					{
+						int key = (i * 7 + t * 13) % keys;
+						int value;
+						if(cache.get(key, value))
+						{
+							if(value != key * 3)
+							{
+								consistent = false;
+							}
+						}
+						else
+						{
+							cache.insert(key, key * 3);
+						}
+
+						if(i % 100 == 0)
+						{
+							cache.erase(key);
+						}
+					}
+				});
+			}
+
+			for(int t = 0; t < threads; ++t)
+			{
+				workers[t].join();
+			}
+
+			GTL_TEST_VERIFY(tc, consistent);
+			GTL_TEST_VERIFY(tc, cache.size() <= 256u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Flat_Containers : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		test_set<Binary_Search<int>>(tc);
+		test_set<Branchless_Search<int>>(tc);
+		test_set<Eytzinger_Search<int>>(tc);
+
+		{
+			typedef Flat_Map<int, int, std::less<int>, Eytzinger_Search<int>> map_type;
+			map_type::value_type entries[] = {{5, 50}, {1, 10}, {3, 30}, {1, 10}, {9, 90}};
+			map_type map(&m_context, make_range(entries));
+
+			GTL_TEST_EQ(tc, map.size(), 4u);
+			GTL_TEST_EQ(tc, *map.find(3), 30);
+			GTL_TEST_VERIFY(tc, map.find(4) == 0);
+
+			for(map_type::range all = map.all(); !all.empty(); all.pop())
+			{
+				all.ref().value += 1;
+			}
+			GTL_TEST_EQ(tc, *map.find(9), 91);
+
+			map[4] = 40;
+			map[0] += 7;
+			GTL_TEST_VERIFY(tc, !map.insert(4, 0).second);
+			GTL_TEST_EQ(tc, *map.find(4), 40);
+			GTL_TEST_EQ(tc, *map.find(0), 7);
+			GTL_TEST_EQ(tc, map.all().get(0).key, 0);
+
+			GTL_TEST_VERIFY(tc, map.erase(5));
+			GTL_TEST_VERIFY(tc, !map.contains(5));
+			GTL_TEST_EQ(tc, map.between(1, 5).size(), 3u);
+		}
+
+		{
+			Flat_Map<int, Vector<int>> map(&m_context);
+			for(int i = 10; i > 0; --i)
+			{
+				map.func_emplace(i, emplace(&m_context)).first->push_back(i);
+			}
+
+			GTL_TEST_EQ(tc, (*map.find(7))[0], 7);
+			GTL_TEST_EQ(tc, map.all().get(0).key, 1);
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+
+private:
+	template <class Search>
+	void test_set(Test_Context& tc)
+	{
+		typedef Flat_Set<int, std::less<int>, Search> set_type;
+
+		//Odd numbers below 100, shuffled and repeated
+		int values[150];
+		for(int i = 0; i < 150; ++i)
+		{
+			values[i] = (i * 37) % 50 * 2 + 1;
+		}
+
+		set_type set(&m_context, make_range(values));
+		GTL_TEST_EQ(tc, set.size(), 50u);
+
+		typename set_type::const_range all = set.all();
+		for(size_t i = 0; i < all.size(); ++i)
+		{
+			GTL_TEST_EQ(tc, all.get(i), int(i * 2 + 1));
+		}
+
+		for(int i = -1; i <= 100; ++i)
+		{
+			GTL_TEST_EQ(tc, set.contains(i), i > 0 && i < 100 && i % 2 == 1);
+			GTL_TEST_EQ(tc, set.lower_bound_index(i), size_t(std::max(i, 0) / 2));
+		}
+
+		//Views go straight into the range algorithms
+		typename set_type::const_range view = set.between(10, 30);
+		GTL_TEST_EQ(tc, view.size(), 10u);
+		GTL_TEST_EQ(tc, slice(view, 2).get(), 15);
+		GTL_TEST_EQ(tc, truncate_range(view, 3).size(), 3u);
+
+		GTL_TEST_VERIFY(tc, set.insert(0));
+		GTL_TEST_VERIFY(tc, !set.insert(1));
+		GTL_TEST_VERIFY(tc, set.insert(100));
+		GTL_TEST_VERIFY(tc, set.erase(51));
+		GTL_TEST_VERIFY(tc, !set.erase(51));
+
+		GTL_TEST_EQ(tc, set.size(), 51u);
+		GTL_TEST_VERIFY(tc, *set.find(0) == 0);
+		GTL_TEST_VERIFY(tc, *set.find(100) == 100);
+		GTL_TEST_VERIFY(tc, set.find(51) == 0);
+		GTL_TEST_VERIFY(tc, set.contains(53));
+
+		set.clear();
+		GTL_TEST_VERIFY(tc, !set.contains(1));
+	}
+};
+
 class Test_List_Base : public Gtl_Test_Case
 {
 public:
@@ -274,6 +923,47 @@ public:
 			temp.clear();
 			GTL_TEST_VERIFY(tc, list.empty() && temp.empty());
 		}
+
+		{
+			//Sizes are kept through every splice
+			Node_T n2(2);
+			list.push_back(n0);
+			list.push_back(n1);
+			list.push_back(n2);
+
+			temp.splice(temp.end(), list, list.begin());
+			GTL_TEST_EQ(tc, list.size(), 2u);
+			GTL_TEST_EQ(tc, temp.size(), 1u);
+
+			temp.splice(temp.end(), list, list.begin(), list.end());
+			GTL_TEST_EQ(tc, list.size(), 0u);
+			GTL_TEST_EQ(tc, temp.size(), 3u);
+
+			typename list_type::iterator second = temp.begin();
+			++second;
+			list.splice(list.end(), temp, second, temp.end(), 2);
+			GTL_TEST_EQ(tc, list.size(), 2u);
+			GTL_TEST_EQ(tc, temp.size(), 1u);
+
+			list.splice(list.begin(), list, ++list.begin(), list.end());
+			GTL_TEST_EQ(tc, list.size(), 2u);
+			GTL_TEST_EQ(tc, list.front().i, 2);
+
+			list.swap(temp);
+			GTL_TEST_EQ(tc, list.size(), 1u);
+			GTL_TEST_EQ(tc, list.front().i, 0);
+			GTL_TEST_EQ(tc, temp.size(), 2u);
+			GTL_TEST_EQ(tc, temp.back().i, 1);
+
+			temp.splice(temp.begin(), list);
+			GTL_TEST_EQ(tc, temp.size(), 3u);
+			GTL_TEST_VERIFY(tc, list.empty());
+
+			temp.pop_front();
+			GTL_TEST_EQ(tc, temp.size(), 2u);
+			temp.clear();
+			GTL_TEST_EQ(tc, temp.size(), 0u);
+		}
 	}
 };
 
@@ -367,6 +1057,438 @@ public:
 	};
 };
 
+class Test_Pooled_List : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			typedef List<int> list_type;
+			Node_Pool<list_type::node_type> pool(&m_context, Pool_Policy(16).grow(2.0f, 256));
+			list_type list(&m_context, &pool);
+			list_type other(&m_context, &pool);
+
+			for(int i = 0; i < 100; ++i)
+			{
+				list.push_back(i);
+			}
+			size_t capacity = pool.capacity();
+			GTL_TEST_VERIFY(tc, capacity >= 100u);
+
+			other.splice(other.end(), list, list.begin());
+			GTL_TEST_EQ(tc, other.front(), 0);
+
+			//Handed back in one go, then reused without growing
+			list.clear();
+			GTL_TEST_VERIFY(tc, list.empty());
+			for(int i = 0; i < 99; ++i)
+			{
+				list.push_front(i);
+			}
+			GTL_TEST_EQ(tc, pool.capacity(), capacity);
+			GTL_TEST_EQ(tc, list.back(), 0);
+			GTL_TEST_EQ(tc, list.size(), 99u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Values with destructors still go node by node
+			typedef List<Vector<int>> list_type;
+			Node_Pool<list_type::node_type> pool(&m_context, 8);
+			list_type list(&m_context, &pool);
+
+			for(int i = 0; i < 8; ++i)
+			{
+				list.func_emplace_back(emplace(&m_context));
+				list.back().push_back(i);
+			}
+			list.pop_front();
+			GTL_TEST_EQ(tc, list.front()[0], 1);
+
+			list.clear();
+			for(int i = 0; i < 8; ++i)
+			{
+				list.func_emplace_back(emplace(&m_context));
+			}
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Unrolled_List : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			typedef Unrolled_List<int, 4> list_type;
+			list_type list(&m_context);
+
+			for(int i = 0; i < 10; ++i)
+			{
+				list.push_back(i);
+			}
+			list.push_front(-1);
+			GTL_TEST_EQ(tc, list.size(), 11u);
+			GTL_TEST_EQ(tc, list.front(), -1);
+			GTL_TEST_EQ(tc, list.back(), 9);
+
+			//Splits the full first node
+			list_type::iterator pos = list.begin();
+			std::advance(pos, 2);
+			pos = list.insert(pos, 100);
+			GTL_TEST_EQ(tc, *pos, 100);
+			GTL_TEST_EQ(tc, *++pos, 1);
+
+			int expected[] = {-1, 0, 100, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+			GTL_TEST_VERIFY(tc, matches(list.all(), expected));
+
+			int count = 12;
+			for(list_type::const_reverse_range r = list.reverse(); !r.empty(); r.pop())
+			{
+				GTL_TEST_EQ(tc, r.get(), expected[--count]);
+			}
+			GTL_TEST_EQ(tc, count, 0);
+
+			int i = 0;
+			for(list_type::iterator it = list.begin(); it != list.end(); ++it, ++i)
+			{
+				GTL_TEST_EQ(tc, *it, expected[i]);
+			}
+			list_type::iterator last = list.end();
+			GTL_TEST_EQ(tc, *--last, 9);
+
+			//Splices the tail of one list and a slice from the middle of another
+			list_type other(&m_context);
+			for(int i = 0; i < 6; ++i)
+			{
+				other.push_back(20 + i);
+			}
+
+			list_type::iterator first = other.begin();
+			std::advance(first, 1);
+			list_type::iterator end = first;
+			std::advance(end, 4);
+			pos = list.begin();
+			std::advance(pos, 3);
+			list.splice(pos, other, first, end);
+			GTL_TEST_EQ(tc, list.size(), 16u);
+			GTL_TEST_EQ(tc, other.size(), 2u);
+			GTL_TEST_EQ(tc, other.front(), 20);
+			GTL_TEST_EQ(tc, other.back(), 25);
+
+			int spliced[] = {-1, 0, 100, 21, 22, 23, 24, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+			GTL_TEST_VERIFY(tc, matches(list.all(), spliced));
+
+			//Within the list, moves the front to just past the middle
+			first = list.begin();
+			end = first;
+			std::advance(end, 3);
+			pos = end;
+			std::advance(pos, 4);
+			list.splice(pos, list, first, end);
+			int moved[] = {21, 22, 23, 24, -1, 0, 100, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+			GTL_TEST_VERIFY(tc, matches(list.all(), moved));
+
+			list.splice(list.end(), other);
+			GTL_TEST_VERIFY(tc, other.empty());
+			GTL_TEST_EQ(tc, list.size(), 18u);
+			GTL_TEST_EQ(tc, list.back(), 25);
+
+			//Emptied nodes are dropped
+			while(list.size() > 1)
+			{
+				pos = list.begin();
+				std::advance(pos, list.size() / 2);
+				list.erase(pos);
+			}
+			list.pop_back();
+			GTL_TEST_VERIFY(tc, list.empty());
+			GTL_TEST_VERIFY(tc, list.all().empty());
+			GTL_TEST_VERIFY(tc, list.reverse().empty());
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			Unrolled_List<Vector<int>, 3> list(&m_context);
+			for(int i = 0; i < 10; ++i)
+			{
+				list.func_emplace_front(emplace(&m_context));
+				list.front().push_back(i);
+			}
+			list.pop_front();
+			list.erase(list.begin());
+			GTL_TEST_EQ(tc, list.front()[0], 7);
+			GTL_TEST_EQ(tc, list.back()[0], 0);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Every way of walking it sees the same elements
+			Unrolled_List<int> unrolled(&m_context);
+			for(int i = 0; i < 1000; ++i)
+			{
+				unrolled.push_back(i);
+			}
+
+			int expected = 0;
+			bool ordered = true;
+			for(Unrolled_List<int>::const_segment_range segments = unrolled.segments(); !segments.empty(); segments.pop())
+			{
+				for(Iterator_Range<int const*> segment = segments.get(); !segment.empty(); segment.pop())
+				{
+					ordered = ordered && segment.get() == expected++;
+				}
+			}
+			GTL_TEST_VERIFY(tc, ordered);
+			GTL_TEST_EQ(tc, expected, 1000);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+
+private:
+	template <class Range_T, size_t N>
+	static bool matches(Range_T range, int const (&expected)[N])
+	{
+		for(size_t i = 0; i < N; ++i, range.pop())
+		{
+			if(range.empty() || range.get() != expected[i])
+			{
+				return false;
+			}
+		}
+		return range.empty();
+	}
+};
+
+struct Queue_Tag {};
+
+//Linked on an ordinary Ilist and on a queue at the same time
+struct Work_Item : public Ilist_Node, public Ilist_Node_T<Queue_Tag>
+{
+	int producer;
+	int sequence;
+};
+
+class Test_Mpsc_Queue : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		static int const producers = 4;
+		static int const per_producer = 20000;
+		static size_t const total = producers * per_producer;
+
+		auto items(scope(new Work_Item[total], [](Work_Item* p){delete[] p;}));
+
+		Ilist<Work_Item> all;
+		for(size_t i = 0; i < total; ++i)
+		{
+			all.push_back(items.get()[i]);
+		}
+
+		Mpsc_Queue<Work_Item, Queue_Tag> queue;
+		GTL_TEST_VERIFY(tc, queue.empty());
+		GTL_TEST_VERIFY(tc, !queue.pop());
+
+		std::thread threads[producers];
+		for(int t = 0; t < producers; ++t)
+		{
+			threads[t] = std::thread([&, t]()
+			{
+				Ilist<Work_Item, Queue_Tag> batch;
+				for(int i = 0; i < per_producer; ++i)
+				{
+					Work_Item& item = items.get()[t * per_producer + i];
+					item.producer = t;
+					item.sequence = i;
+
+					//Every other thread publishes in batches
+					if(t % 2)
+					{
+						batch.push_back(item);
+						if(batch.size() == 16)
+						{
+							queue.push_all(batch);
+						}
+					}
+					else
+					{
+						queue.push(item);
+					}
+				}
+				queue.push_all(batch);
+			});
+		}
+
+		int next[producers] = {0};
+		bool ordered = true;
+		size_t received = 0;
+		Ilist<Work_Item, Queue_Tag> drained;
+		while(received < total)
+		{
+			if(received % 2)
+			{
+				if(Work_Item* item = queue.pop())
+				{
+					ordered = ordered && item->sequence == next[item->producer]++;
+					++received;
+				}
+			}
+			else if(size_t count = queue.pop_all(drained))
+			{
+				GTL_TEST_EQ(tc, drained.size(), count);
+				for(Ilist<Work_Item, Queue_Tag>::range r = drained.all(); !r.empty(); r.pop())
+				{
+					ordered = ordered && r.ref().sequence == next[r.ref().producer]++;
+				}
+				received += count;
+				drained.clear();
+			}
+		}
+
+		for(int t = 0; t < producers; ++t)
+		{
+			threads[t].join();
+			GTL_TEST_EQ(tc, next[t], per_producer);
+		}
+
+		GTL_TEST_VERIFY(tc, ordered);
+		GTL_TEST_VERIFY(tc, queue.empty());
+		GTL_TEST_VERIFY(tc, !queue.pop());
+
+		//The other hook was left alone
+		GTL_TEST_EQ(tc, all.size(), total);
+		GTL_TEST_EQ(tc, &all.back(), items.get() + total - 1);
+	}
+};
+
+class Test_Slist : public Gtl_Test_Case
+{
+public:
+	struct Node : public Slist_Node, public Ilist_Node
+	{
+		Node() : i(0) {}
+		Node(int i) : i(i) {}
+
+		int i;
+	};
+
+	virtual void run(Test_Context& tc)
+	{
+		GTL_TEST_EQ(tc, sizeof(Slist_Node), sizeof(void*));
+
+		Node nodes[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+		Slist<Node> list;
+		Slist<Node> other;
+
+		list.push_back(nodes[2]);
+		list.push_front(nodes[1]);
+		list.push_back(nodes[4]);
+		list.insert_after(list.begin(), nodes[3]);
+		list.insert_after(list.get_iterator(nodes[4]), nodes[5]);
+		GTL_TEST_EQ(tc, list.size(), 5u);
+		GTL_TEST_EQ(tc, list.front().i, 1);
+		GTL_TEST_EQ(tc, list.back().i, 5);
+
+		list.erase_after(list.begin());
+		list.erase_after(list.get_iterator(nodes[4]));
+		GTL_TEST_EQ(tc, list.back().i, 4);
+
+		other.push_back(nodes[0]);
+		list.splice_front(other);
+		other.push_front(nodes[6]);
+		other.push_back(nodes[7]);
+		list.splice_back(other);
+		GTL_TEST_VERIFY(tc, other.empty());
+		GTL_TEST_EQ(tc, list.size(), 6u);
+
+		int expected[] = {0, 1, 2, 4, 6, 7};
+		int i = 0;
+		for(Slist<Node>::const_range r = list.all(); !r.empty(); r.pop(), ++i)
+		{
+			GTL_TEST_EQ(tc, r.get().i, expected[i]);
+		}
+		GTL_TEST_EQ(tc, i, 6);
+
+		//Other containers take Slist ranges as is
+		Ilist<Node> ilist;
+		ilist.insert_range(ilist.end(), list.all());
+		GTL_TEST_EQ(tc, ilist.size(), 6u);
+		GTL_TEST_EQ(tc, ilist.back().i, 7);
+
+		list.pop_front();
+		GTL_TEST_EQ(tc, list.front().i, 1);
+		list.clear();
+		GTL_TEST_VERIFY(tc, list.all().empty());
+
+		test_atomic(tc);
+	}
+
+private:
+	void test_atomic(Test_Context& tc)
+	{
+		static int const threads = 4;
+		static int const node_count = 64;
+		static int const rounds = 20000;
+
+		Node nodes[node_count];
+		Atomic_Slist<Node> stack;
+		GTL_TEST_VERIFY(tc, !stack.pop());
+		GTL_TEST_VERIFY(tc, Atomic_Slist<Node>::max_tag >= 0xffff);
+
+		Slist<Node> batch;
+		for(int i = 0; i < node_count; ++i)
+		{
+			nodes[i].i = i;
+			batch.push_back(nodes[i]);
+		}
+		stack.push_all(batch);
+		GTL_TEST_VERIFY(tc, batch.empty());
+		GTL_TEST_EQ(tc, stack.pop(), &nodes[0]);
+		stack.push(nodes[0]);
+
+		//The same nodes keep cycling through every thread
+		std::thread workers[threads];
+		for(int t = 0; t < threads; ++t)
+		{
+			workers[t] = std::thread([&]()
+			{
+				Slist<Node> held;
+				for(int i = 0; i < rounds; ++i)
+				{
+					if(Node* node = stack.pop())
+					{
+						held.push_front(*node);
+					}
+
+					if(held.size() == 4 || (i % 7 == 0 && !held.empty()))
+					{
+						stack.push_all(held);
+					}
+				}
+				stack.push_all(held);
+			});
+		}
+
+		for(int t = 0; t < threads; ++t)
+		{
+			workers[t].join();
+		}
+
+		Slist<Node> all;
+		GTL_TEST_EQ(tc, stack.pop_all(all), size_t(node_count));
+		GTL_TEST_VERIFY(tc, stack.empty());
+
+		bool seen[node_count] = {false};
+		for(Slist<Node>::range r = all.all(); !r.empty(); r.pop())
+		{
+			GTL_TEST_VERIFY(tc, !seen[r.get().i]);
+			seen[r.get().i] = true;
+		}
+	}
+};
+
 class Test_Registry : public Gtl_Test_Case
 {
 public:
@@ -399,6 +1521,392 @@ public:
 	}
 };
 
+class Test_Dense_Registry : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+		typedef Dense_Registry<int> registry_type;
+
+		{
+			registry_type reg(&m_context);
+
+			uint path[] = {2, 5};
+			auto path_range(make_range(path));
+
+			GTL_TEST_EQ(tc, reg.try_get_path(path_range), registry_type::missing);
+			node_id written = reg.get_path(path_range);
+			GTL_TEST_VERIFY(tc, written != registry_type::missing);
+			reg.data(written) = 5;
+
+			Fixed_Path<uint, 5> path2;
+			path2.append(2).append(5);
+			node_id read = reg.try_get_path(path2.get());
+			GTL_TEST_EQ(tc, read, written);
+			GTL_TEST_EQ(tc, reg.data(read), 5);
+
+			path[1] = 3;
+			GTL_TEST_EQ(tc, reg.try_get_path(path_range), registry_type::missing);
+			GTL_TEST_EQ(tc, reg.size(), 3u);
+		}
+
+		{
+			//Scattered indices go sparse, then dense again once filled in
+			registry_type reg(&m_context);
+			node_id far = reg.get(registry_type::root, 1000);
+			reg.data(far) = 1000;
+			node_id near = reg.get(registry_type::root, 1);
+			reg.data(near) = 1;
+			reg.get(registry_type::root, 100000);
+
+			for(uint i = 0; i < 1000; i += 3)
+			{
+				reg.data(reg.get(registry_type::root, i)) = int(i);
+			}
+			GTL_TEST_EQ(tc, reg.data(reg.try_get(registry_type::root, 999)), 999);
+			GTL_TEST_EQ(tc, reg.data(reg.try_get(registry_type::root, 1000)), 1000);
+			GTL_TEST_EQ(tc, reg.try_get(registry_type::root, 998), registry_type::missing);
+			GTL_TEST_EQ(tc, reg.try_get(registry_type::root, 2000), registry_type::missing);
+			GTL_TEST_EQ(tc, reg.child_count(registry_type::root), 337u);
+
+			uint previous = 0;
+			size_t count = 0;
+			bool ordered = true;
+			for(registry_type::Child_Range r = reg.children(registry_type::root); !r.empty(); r.pop(), ++count)
+			{
+				registry_type::Child child = r.get();
+				ordered = ordered && (count == 0 || child.index > previous);
+				ordered = ordered && reg.try_get(registry_type::root, child.index) == child.node;
+				previous = child.index;
+			}
+			GTL_TEST_VERIFY(tc, ordered);
+			GTL_TEST_EQ(tc, count, 337u);
+			GTL_TEST_EQ(tc, previous, 100000u);
+
+			reg.clear();
+			GTL_TEST_EQ(tc, reg.size(), 1u);
+			GTL_TEST_VERIFY(tc, reg.children(registry_type::root).empty());
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Deep paths, against the pointer based Node
+			static size_t const paths = 1 << 10;
+			static size_t const depth = 12;
+			Vector<uint> steps(&m_context);
+			uint seed = 1;
+			for(size_t i = 0; i < paths * depth; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				steps.push_back((seed >> 16) % 6);
+			}
+
+			Node<int> tree(&m_context);
+			registry_type dense(&m_context);
+			for(size_t i = 0; i < paths; ++i)
+			{
+				auto path = steps.all().slice(i * depth, (i + 1) * depth);
+				tree.get_path(path)->data() = int(i);
+				dense.data(dense.get_path(path)) = int(i);
+			}
+
+			bool same = true;
+			for(size_t i = 0; i < paths; ++i)
+			{
+				auto path = steps.all().slice(i * depth, (i + 1) * depth);
+				same = same && dense.data(dense.try_get_path(path)) == tree.try_get_path(path)->data();
+			}
+			GTL_TEST_VERIFY(tc, same);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Radix_Registry : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+		typedef Radix_Registry<int> registry_type;
+
+		{
+			registry_type reg(&m_context);
+
+			Fixed_Path<uint, 8> long_path;
+			long_path.append(1).append(2).append(3).append(4).append(5).append(6);
+			node_id leaf = reg.get_path(long_path.get());
+			reg.data(leaf) = 6;
+			GTL_TEST_EQ(tc, reg.node_count(), 2u);
+			GTL_TEST_EQ(tc, reg.label(leaf).size(), 6u);
+
+			//Branches off in the middle of the run
+			uint branch[] = {1, 2, 3, 9};
+			node_id other = reg.get_path(make_range(branch));
+			reg.data(other) = 9;
+			GTL_TEST_EQ(tc, reg.node_count(), 4u);
+			GTL_TEST_EQ(tc, reg.label(leaf).size(), 3u);
+
+			//Ends exactly at the split
+			uint prefix[] = {1, 2, 3};
+			GTL_TEST_EQ(tc, reg.try_get_path(make_range(prefix)), registry_type::missing);
+			node_id middle = reg.get_path(make_range(prefix));
+			reg.data(middle) = 3;
+			GTL_TEST_EQ(tc, reg.node_count(), 4u);
+
+			GTL_TEST_EQ(tc, reg.data(reg.try_get_path(long_path.get())), 6);
+			GTL_TEST_EQ(tc, reg.data(reg.try_get_path(make_range(branch))), 9);
+			GTL_TEST_EQ(tc, reg.data(reg.try_get_path(make_range(prefix))), 3);
+			GTL_TEST_EQ(tc, reg.size(), 4u);
+
+			uint partial[] = {1, 2};
+			uint past[] = {1, 2, 3, 9, 0};
+			GTL_TEST_EQ(tc, reg.try_get_path(make_range(partial)), registry_type::missing);
+			GTL_TEST_EQ(tc, reg.try_get_path(make_range(past)), registry_type::missing);
+			GTL_TEST_EQ(tc, reg.try_get_path(make_range(prefix, prefix)), registry_type::root);
+
+			size_t children = 0;
+			for(registry_type::Child_Range r = reg.children(middle); !r.empty(); r.pop())
+			{
+				++children;
+				GTL_TEST_VERIFY(tc, r.get() == leaf || r.get() == other);
+			}
+			GTL_TEST_EQ(tc, children, 2u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//A few shared levels, then long unique suffixes
+			static size_t const paths = 1 << 10;
+			static size_t const depth = 16;
+			Vector<uint> steps(&m_context);
+			uint seed = 7;
+			for(size_t i = 0; i < paths * depth; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				steps.push_back(i % depth < 3 ? (seed >> 16) % 4 : (seed >> 16) % 1000);
+			}
+
+			Node<int> tree(&m_context);
+			registry_type radix(&m_context);
+			for(size_t i = 0; i < paths; ++i)
+			{
+				auto path = steps.all().slice(i * depth, (i + 1) * depth);
+				tree.get_path(path)->data() = int(i);
+				radix.data(radix.get_path(path)) = int(i);
+			}
+			GTL_TEST_VERIFY(tc, radix.node_count() < paths * 2);
+
+			bool same = true;
+			for(size_t i = 0; i < paths; ++i)
+			{
+				auto path = steps.all().slice(i * depth, (i + 1) * depth);
+				same = same && radix.data(radix.try_get_path(path)) == tree.try_get_path(path)->data();
+			}
+			GTL_TEST_VERIFY(tc, same);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Rcu_Registry : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+		typedef Rcu_Registry<int> registry_type;
+
+		{
+			registry_type reg(&m_context);
+			registry_type::Reader reader(reg);
+
+			uint path[] = {2, 5};
+			auto path_range(make_range(path));
+			{
+				registry_type::Snapshot before(reader);
+				GTL_TEST_VERIFY(tc, !before.try_get_path(path_range));
+
+				reg.set(path_range, 5);
+
+				//Still pinned to the old tree, which can't be freed yet
+				GTL_TEST_VERIFY(tc, !before.try_get_path(path_range));
+				GTL_TEST_EQ(tc, before.root()->count(), 0u);
+				GTL_TEST_VERIFY(tc, reg.retired_count() > 0);
+
+				registry_type::Snapshot after(reader);
+				GTL_TEST_EQ(tc, after.try_get_path(path_range)->data(), 5);
+				GTL_TEST_EQ(tc, after.root()->count(), 3u);
+			}
+			reg.reclaim();
+			GTL_TEST_EQ(tc, reg.retired_count(), 0u);
+
+			//Siblings are shared, not copied
+			uint sibling[] = {2, 1};
+			reg.update(make_range(sibling), [](int& data){data += 7;});
+			registry_type::Snapshot snapshot(reader);
+			GTL_TEST_EQ(tc, snapshot.try_get_path(make_range(sibling))->data(), 7);
+			GTL_TEST_EQ(tc, snapshot.try_get_path(path_range)->data(), 5);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Readers check every node they find carries its own path
+			static int const readers = 3;
+			static int const updates = 5000;
+
+			registry_type reg(&m_context);
+			std::atomic<bool> done(false);
+			std::atomic<bool> consistent(true);
+
+			std::thread threads[readers];
+			for(int t = 0; t < readers; ++t)
+			{
+				threads[t] = std::thread([&]()
+				{
+					registry_type::Reader reader(reg);
+					while(!done.load())
+					{
+						registry_type::Snapshot snapshot(reader);
+						for(uint a = 0; a < 8; ++a)
+						{
+							for(uint b = 0; b < 8; ++b)
+							{
+								uint path[] = {a, b};
+								if(registry_type::node_type const* node = snapshot.try_get_path(make_range(path)))
+								{
+									int data = node->data();
+									if(data != 0 && data % 100 != int(a * 10 + b))
+									{
+										consistent = false;
+									}
+								}
+							}
+						}
+					}
+				});
+			}
+
+			for(int i = 0; i < updates; ++i)
+			{
+				uint path[] = {uint(i * 7 % 8), uint(i * 3 % 8)};
+				int key = int(path[0] * 10 + path[1]);
+				reg.update(make_range(path), [&](int& data){data = (data / 100 + 1) * 100 + key;});
+			}
+
+			done = true;
+			for(int t = 0; t < readers; ++t)
+			{
+				threads[t].join();
+			}
+
+			GTL_TEST_VERIFY(tc, consistent);
+			reg.reclaim();
+			GTL_TEST_EQ(tc, reg.retired_count(), 0u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Registry_Image : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		using namespace registry;
+		typedef Image_View<int> view_type;
+
+		{
+			Node<int> tree(&m_context);
+			tree.data() = -1;
+
+			Vector<uint> steps(&m_context);
+			uint seed = 3;
+			for(size_t i = 0; i < 256 * 4; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				steps.push_back((seed >> 16) % 6);
+			}
+			for(size_t i = 0; i < 256; ++i)
+			{
+				tree.get_path(steps.all().slice(i * 4, (i + 1) * 4))->data() = int(i);
+			}
+
+			Vector<char> image(&m_context);
+			freeze(&m_context, tree, image);
+
+			//Read back from somewhere else, as if mapped from a file
+			Vector<uint64_t> copy(&m_context);
+			copy.resize((image.size() + 7) / 8, 0);
+			std::memcpy(copy.begin(), image.begin(), image.size());
+
+			view_type view;
+			GTL_TEST_VERIFY(tc, view.open(copy.begin(), image.size()));
+			GTL_TEST_VERIFY(tc, view.verify());
+			GTL_TEST_EQ(tc, view.data(view_type::root), -1);
+
+			for(size_t i = 0; i < 256; ++i)
+			{
+				auto path = steps.all().slice(i * 4, (i + 1) * 4);
+				node_id node = view.try_get_path(path);
+				GTL_TEST_VERIFY(tc, node != view_type::missing);
+				GTL_TEST_EQ(tc, view.data(node), tree.try_get_path(path)->data());
+			}
+
+			uint absent[] = {7, 0};
+			GTL_TEST_EQ(tc, view.try_get_path(make_range(absent)), view_type::missing);
+
+			//Every node is reached exactly once through children
+			size_t reached = 1;
+			for(node_id node = 0; node < view.size(); ++node)
+			{
+				for(view_type::range r = view.children(node); !r.empty(); r.pop())
+				{
+					reached += r.get() != view_type::missing;
+				}
+			}
+			GTL_TEST_EQ(tc, reached, view.size());
+
+			//Truncated or foreign images are refused
+			view_type bad;
+			GTL_TEST_VERIFY(tc, !bad.open(copy.begin(), image.size() - 1));
+			GTL_TEST_VERIFY(tc, !Image_View<int64_t>().open(copy.begin(), image.size()));
+			reinterpret_cast<char*>(copy.begin())[0] ^= 1;
+			GTL_TEST_VERIFY(tc, !bad.open(copy.begin(), image.size()));
+			GTL_TEST_VERIFY(tc, !bad.is_open());
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			//Images appended after odd lengths still start aligned
+			Node<int64_t> tree(&m_context);
+			tree.data() = 5;
+			uint path[] = {2, 1};
+			tree.get_path(make_range(path))->data() = 7;
+
+			Vector<char> image(&m_context);
+			image.push_back('x');
+			size_t first = freeze(&m_context, tree, image);
+			image.push_back('y');
+			size_t second = freeze(&m_context, tree, image);
+			GTL_TEST_EQ(tc, first % 8, 0u);
+			GTL_TEST_EQ(tc, second % 8, 0u);
+
+			Vector<uint64_t> copy(&m_context);
+			copy.resize((image.size() + 7) / 8, 0);
+			std::memcpy(copy.begin(), image.begin(), image.size());
+
+			char const* base = reinterpret_cast<char const*>(copy.begin());
+			Image_View<int64_t> view;
+			GTL_TEST_VERIFY(tc, view.open(base + first, second - first));
+			GTL_TEST_EQ(tc, view.data(view.try_get_path(make_range(path))), 7);
+			GTL_TEST_VERIFY(tc, view.open(base + second, image.size() - second));
+			GTL_TEST_EQ(tc, view.data(view.try_get_path(make_range(path))), 7);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
 
 void test_containers(Test_Platform& platform)
 {
@@ -410,14 +1918,56 @@ void test_containers(Test_Platform& platform)
 	Test_Vector test_vector;
 	suite.run("vector", test_vector);
 
+	Test_Vector_Growth test_vector_growth;
+	suite.run("vector growth", test_vector_growth);
+
+	Test_Vector_Move test_vector_move;
+	suite.run("vector move", test_vector_move);
+
+	Test_Small_Vector test_small_vector;
+	suite.run("small vector", test_small_vector);
+
+	Test_Hash_Map test_hash_map;
+	suite.run("hash map", test_hash_map);
+
+	Test_Lru_Cache test_lru_cache;
+	suite.run("lru cache", test_lru_cache);
+
+	Test_Flat_Containers test_flat;
+	suite.run("flat containers", test_flat);
+
 	Test_Ilist test_ilist;
 	suite.run("intrusive list", test_ilist);
 
 	Test_List test_list;
 	suite.run("list", test_list);
 
+	Test_Pooled_List test_pooled_list;
+	suite.run("pooled list", test_pooled_list);
+
+	Test_Unrolled_List test_unrolled_list;
+	suite.run("unrolled list", test_unrolled_list);
+
+	Test_Mpsc_Queue test_mpsc_queue;
+	suite.run("mpsc queue", test_mpsc_queue);
+
+	Test_Slist test_slist;
+	suite.run("slist", test_slist);
+
 	Test_Registry test_registry;
-	suite.run("registry", test_list);
+	suite.run("registry", test_registry);
+
+	Test_Dense_Registry test_dense_registry;
+	suite.run("dense registry", test_dense_registry);
+
+	Test_Radix_Registry test_radix_registry;
+	suite.run("radix registry", test_radix_registry);
+
+	Test_Rcu_Registry test_rcu_registry;
+	suite.run("rcu registry", test_rcu_registry);
+
+	Test_Registry_Image test_registry_image;
+	suite.run("registry image", test_registry_image);
 }
 
 } //ns
@@ -17,6 +17,7 @@
 
 #include "common.h"
 #include <gtl/pool.h>
+#include <thread>
 
 namespace gtl {
 
@@ -92,12 +93,212 @@ public:
 	}
 };
 
+class Test_Growable_Pool : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			Node_Pool<int> pool(&m_context, Pool_Policy(2).grow(2.0f, 8));
+			int* ptr[20];
+			for(int i = 0; i < 20; ++i)
+			{
+				GTL_TEST_VERIFY(tc, !pool.empty());
+				ptr[i] = pool.create(emplace(i));
+			}
+
+			//2 + 4 + 8 + 8
+			GTL_TEST_EQ(tc, pool.capacity(), 22u);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 4);
+
+			//Offsets are unique across slabs
+			bool seen[22] = {false};
+			for(int i = 0; i < 20; ++i)
+			{
+				size_t offset = pool.offset_of(ptr[i]);
+				GTL_TEST_VERIFY(tc, offset < 22 && !seen[offset]);
+				seen[offset] = true;
+				GTL_TEST_EQ(tc, *ptr[i], i);
+			}
+
+			for(int i = 0; i < 20; ++i)
+			{
+				pool.destroy(ptr[i]);
+			}
+
+			//No high water mark, slabs are only released on demand
+			GTL_TEST_EQ(tc, pool.capacity(), 22u);
+			GTL_TEST_EQ(tc, pool.trim(), 22u);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+			//Grows again from the last slab size
+			pool.destroy(pool.create());
+			GTL_TEST_EQ(tc, pool.capacity(), 8u);
+		}
+
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			Node_Pool<int> pool(&m_context, Pool_Policy(4).grow(1.0f, 4).release_above(4));
+			int* ptr[16];
+			for(int i = 0; i < 16; ++i)
+			{
+				ptr[i] = pool.create();
+			}
+			GTL_TEST_EQ(tc, pool.capacity(), 16u);
+
+			for(int i = 0; i < 16; ++i)
+			{
+				pool.destroy(ptr[i]);
+			}
+
+			//Free slabs beyond the high water mark went back to the allocator
+			GTL_TEST_VERIFY(tc, pool.capacity() <= 8u);
+			GTL_TEST_VERIFY(tc, pool.capacity() >= 4u);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), (int) pool.capacity() / 4);
+		}
+
+		{
+			//Many slabs, trimmed out of the middle of the index
+			Node_Pool<int> pool(&m_context, Pool_Policy(4).grow(1.0f, 4));
+			int* ptr[1024];
+			for(int i = 0; i < 1024; ++i)
+			{
+				ptr[i] = pool.create(emplace(i));
+			}
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 256);
+
+			for(int i = 0; i < 1024; ++i)
+			{
+				if(i / 4 % 2)
+				{
+					pool.destroy(ptr[i]);
+					ptr[i] = 0;
+				}
+			}
+			GTL_TEST_EQ(tc, pool.trim(), 512u);
+			GTL_TEST_EQ(tc, m_alloc.outstanding(), 128);
+
+			bool offsets_ok = true;
+			for(int i = 0; i < 1024; ++i)
+			{
+				if(ptr[i])
+				{
+					offsets_ok = offsets_ok && pool.offset_of(ptr[i]) < 1024 && *ptr[i] == i;
+					pool.destroy(ptr[i]);
+				}
+			}
+			GTL_TEST_VERIFY(tc, offsets_ok);
+			GTL_TEST_EQ(tc, pool.trim(), 512u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Concurrent_Pool : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		typedef Concurrent_Node_Pool<int> pool_type;
+		static int const count = 1000;
+
+		pool_type pool(&m_context, Pool_Policy(64).grow(2.0f, 1024), 8);
+		int* ptr[count];
+
+		//Allocate on one thread, free on another
+		std::thread producer([&]()
+		{
+			pool_type::Cache cache(pool);
+			for(int i = 0; i < count; ++i)
+			{
+				ptr[i] = cache.create(emplace(i));
+			}
+		});
+		producer.join();
+
+		//Checked on the main thread, Test_Context isn't thread safe
+		bool consumed = true;
+		std::thread consumer([&]()
+		{
+			pool_type::Cache cache(pool);
+			for(int i = 0; i < count; ++i)
+			{
+				consumed = consumed && *ptr[i] == i;
+				cache.destroy(ptr[i]);
+			}
+		});
+		consumer.join();
+		GTL_TEST_VERIFY(tc, consumed);
+
+		size_t capacity = pool.capacity();
+
+		//Churn from several threads at once
+		std::thread workers[4];
+		bool churned[4] = {true, true, true, true};
+		for(int t = 0; t < 4; ++t)
+		{
+			workers[t] = std::thread([&, t]()
+			{
+				pool_type::Cache cache(pool);
+				int* local[50];
+				for(int round = 0; round < 100; ++round)
+				{
+					for(int i = 0; i < 50; ++i)
+					{
+						local[i] = cache.create(emplace(t * 1000 + i));
+					}
+
+					for(int i = 0; i < 50; ++i)
+					{
+						churned[t] = churned[t] && *local[i] == t * 1000 + i;
+						cache.destroy(local[i]);
+					}
+				}
+			});
+		}
+
+		for(int t = 0; t < 4; ++t)
+		{
+			workers[t].join();
+			GTL_TEST_VERIFY(tc, churned[t]);
+		}
+
+		//Everything was recycled, no growth needed
+		GTL_TEST_EQ(tc, pool.capacity(), capacity);
+
+		{
+			//Fixed pool smaller than one magazine
+			pool_type small(&m_context, Pool_Policy(10));
+			pool_type::Cache cache(small);
+			int* all[10];
+			for(int i = 0; i < 10; ++i)
+			{
+				all[i] = cache.create(emplace(i));
+			}
+
+			for(int i = 0; i < 10; ++i)
+			{
+				GTL_TEST_EQ(tc, *all[i], i);
+				cache.destroy(all[i]);
+			}
+			GTL_TEST_EQ(tc, small.capacity(), 10u);
+		}
+	}
+};
+
 void test_pool(Test_Platform& platform)
 {
 	Test_Suite suite("pool", platform);
 
 	Test_Node_Pool test;
 	suite.run("node pool", test);
+
+	Test_Growable_Pool test_growable;
+	suite.run("growable pool", test_growable);
+
+	Test_Concurrent_Pool test_concurrent;
+	suite.run("concurrent pool", test_concurrent);
 }
 
 } //ns
@@ -17,6 +17,18 @@
 #include "common.h"
 #include <gtl/stream.h>
 #include <gtl/containers/vector.h>
+#include <gtl/stream/readahead_stream.h>
+#include <gtl/stream/spsc_ring.h>
+#include <gtl/string/cstr.h>
+#include <algorithm>
+#include <thread>
+
+#ifndef _MSC_VER
+#	include <gtl/stream/posix/file_stream.h>
+#	include <gtl/stream/posix/mapped_stream.h>
+#	include <stdlib.h>
+#	include <unistd.h>
+#endif
 
 namespace gtl {
 
@@ -87,12 +99,428 @@ public:
 	}
 };
 
+class Test_Stream_Block : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		int ref[5] = {0, 1, 3, 4, 7};
+		{
+			int out[3] = {0};
+
+			auto in_stream = range_in_stream<int>(make_range(ref));
+			auto out_stream = range_out_stream<int>(make_range(out));
+
+			int buffer[8];
+			GTL_TEST_EQ(tc, in_stream.read(buffer, 2), 2u);
+			GTL_TEST_EQ(tc, in_stream.read(buffer + 2, 8), 3u);
+			GTL_TEST_VERIFY(tc, in_stream.eof());
+			GTL_TEST_EQ(tc, in_stream.read(buffer, 8), 0u);
+
+			//Stops short at the end of the output range
+			GTL_TEST_EQ(tc, out_stream.write(buffer, 5), 3u);
+			GTL_TEST_VERIFY(tc, out_stream.eof());
+			for(uint i = 0; i < 3; ++i)
+			{
+				GTL_TEST_EQ(tc, ref[i], out[i]);
+			}
+		}
+
+		{
+			gtl::Vector<int> in(&m_context);
+			gtl::Vector<int> out(&m_context);
+
+			in.assign(ref, ref + 5);
+			auto in_stream = container_in_stream<int>(in);
+			auto in_adapter = adapter_in_stream<int>(in_stream, [](int x) -> int {return x + 1;});
+
+			auto out_stream = container_out_stream<int>(out);
+			auto out_adapter = adapter_out_stream<int>(out_stream, [](int x) -> int {return x + 2;});
+
+			int buffer[4];
+			while(size_t n = in_adapter.read(buffer, 4))
+			{
+				GTL_TEST_EQ(tc, out_adapter.write(buffer, n), n);
+			}
+
+			GTL_TEST_EQ(tc, out.size(), 5u);
+			for(uint i = 0; i < 5; ++i)
+			{
+				GTL_TEST_EQ(tc, ref[i] + 3, out[i]);
+			}
+		}
+
+		{
+			//Default read and write go through get and put
+			gtl::Vector<short> in(&m_context);
+			gtl::Vector<int> out(&m_context);
+
+			in.assign(ref, ref + 5);
+			auto in_stream = container_in_stream<short>(in);
+			auto in_adapter = adapter_in_stream<int>(in_stream, [](short x) -> int {return x * 2;});
+
+			int buffer[8];
+			GTL_TEST_EQ(tc, in_adapter.read(buffer, 8), 5u);
+			for(uint i = 0; i < 5; ++i)
+			{
+				GTL_TEST_EQ(tc, ref[i] * 2, buffer[i]);
+			}
+		}
+
+		{
+			//Blocks straddling the end of the source
+			gtl::Vector<int> in(&m_context);
+			gtl::Vector<int> out(&m_context);
+			for(int i = 0; i < 10000; ++i)
+			{
+				in.push_back(i);
+			}
+
+			auto in_stream = container_in_stream<int>(in);
+			auto out_stream = container_out_stream<int>(out);
+			Input_Stream<int>& input = in_stream;
+			Output_Stream<int>& output = out_stream;
+			int buffer[4096];
+			while(size_t n = input.read(buffer, 4096))
+			{
+				GTL_TEST_EQ(tc, output.write(buffer, n), n);
+			}
+
+			GTL_TEST_EQ(tc, out.size(), in.size());
+			GTL_TEST_VERIFY(tc, std::equal(out.begin(), out.end(), in.begin()));
+		}
+	}
+};
+
+class Test_Pipeline : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		int ref[6] = {0, 1, 3, 4, 7, 8};
+		{
+			gtl::Vector<int> out(&m_context);
+
+			size_t count = make_range(ref)
+				| map([](int x) {return x * 3;})
+				| filter([](int x) {return x % 2 == 0;})
+				| map([](int x) {return x + 1;})
+				| to_container(out);
+
+			int expected[3] = {1, 13, 25};
+			GTL_TEST_EQ(tc, count, 3u);
+			GTL_TEST_EQ(tc, out.size(), 3u);
+			for(uint i = 0; i < 3; ++i)
+			{
+				GTL_TEST_EQ(tc, expected[i], out[i]);
+			}
+
+			//Nothing passes
+			GTL_TEST_EQ(tc, make_range(ref) | filter([](int x) {return x < 0;}) | to_container(out), 0u);
+			GTL_TEST_EQ(tc, out.size(), 3u);
+
+			//A map ahead of a filter runs once per element
+			int calls = 0;
+			int sum = 0;
+			make_range(ref)
+				| map([&](int x) {++calls; return x;})
+				| filter([](int x) {return x % 2 == 0;})
+				| sink([&](int x) {sum += x;});
+			GTL_TEST_EQ(tc, calls, 6);
+			GTL_TEST_EQ(tc, sum, 12);
+		}
+
+		{
+			//Through the virtual interfaces and back
+			auto in_stream = range_in_stream<int>(make_range(ref));
+			auto mapped = stream_range<int>(in_stream) | map([](int x) {return x - 1;});
+			auto erased = range_in_stream<int>(mapped);
+			Input_Stream<int>& input = erased;
+
+			int out[4] = {0};
+			auto out_stream = range_out_stream<int>(make_range(out));
+			GTL_TEST_EQ(tc, stream_range(input) | to_stream<int>(out_stream), 4u);
+			for(uint i = 0; i < 4; ++i)
+			{
+				GTL_TEST_EQ(tc, ref[i] - 1, out[i]);
+			}
+
+			int sum = 0;
+			stream_range(input) | sink([&](int x) {sum += x;});
+			GTL_TEST_EQ(tc, sum, (ref[4] - 1) + (ref[5] - 1));
+			GTL_TEST_VERIFY(tc, input.eof());
+		}
+	}
+};
+
+class Test_Readahead_Stream : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		{
+			gtl::Vector<int> in(&m_context);
+			for(int i = 0; i < 100000; ++i)
+			{
+				in.push_back(i * 7);
+			}
+
+			auto source = container_in_stream<int>(in);
+			Async_Readahead_Stream<int> stream(&m_context, source, 1000, 3);
+
+			gtl::Vector<int> out(&m_context);
+			int buffer[777];
+			while(!stream.eof())
+			{
+				//Mixes single elements with blocks straddling buffers
+				out.push_back(stream.get());
+				size_t n = stream.read(buffer, out.size() % 777);
+				out.insert(out.end(), buffer, buffer + n);
+			}
+
+			GTL_TEST_EQ(tc, stream.read(buffer, 10), 0u);
+			GTL_TEST_EQ(tc, out.size(), in.size());
+			GTL_TEST_VERIFY(tc, std::equal(out.begin(), out.end(), in.begin()));
+		}
+
+		{
+			//Empty source, and one torn down before it's drained
+			gtl::Vector<int> in(&m_context);
+			auto empty = container_in_stream<int>(in);
+			Async_Readahead_Stream<int> stream(&m_context, empty);
+			GTL_TEST_VERIFY(tc, stream.eof());
+
+			in.resize(5000, 1);
+			auto source = container_in_stream<int>(in);
+			Async_Readahead_Stream<int> partial(&m_context, source, 100, 2);
+			GTL_TEST_EQ(tc, partial.get(), 1);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+class Test_Spsc_Ring : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		typedef Spsc_Ring<int> ring_type;
+
+		{
+			ring_type ring(&m_context, 6, 4);
+			GTL_TEST_EQ(tc, ring.capacity(), 8u);
+
+			int value = 0;
+			GTL_TEST_VERIFY(tc, !ring.try_pop(value));
+
+			//Below the batch nothing is visible until published
+			ring.push(1);
+			GTL_TEST_VERIFY(tc, !ring.try_pop(value));
+			ring.publish();
+			GTL_TEST_VERIFY(tc, ring.try_pop(value));
+			GTL_TEST_EQ(tc, value, 1);
+
+			//Likewise the slot is only handed back once released
+			GTL_TEST_VERIFY(tc, ring.try_push(0));
+			for(int i = 1; i < 8; ++i)
+			{
+				GTL_TEST_EQ(tc, ring.try_push(i), i < 7);
+			}
+			ring.release();
+			GTL_TEST_VERIFY(tc, ring.try_push(7));
+			GTL_TEST_VERIFY(tc, !ring.try_push(8));
+
+			int buffer[8];
+			GTL_TEST_EQ(tc, ring.pop_some(buffer, 5), 5u);
+			ring.release();
+			int more[6] = {8, 9, 10, 11, 12, 13};
+			GTL_TEST_EQ(tc, ring.push_some(more, 6), 5u);
+			ring.close();
+
+			ring_type::Consumer consumer(ring);
+			gtl::Vector<int> out(&m_context);
+			out.insert(out.end(), buffer, buffer + 5);
+			while(!consumer.eof())
+			{
+				out.push_back(consumer.get());
+			}
+			GTL_TEST_EQ(tc, out.size(), 13u);
+			for(int i = 0; i < 13; ++i)
+			{
+				GTL_TEST_EQ(tc, out[i], i);
+			}
+			GTL_TEST_EQ(tc, consumer.read(buffer, 8), 0u);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+
+		{
+			static int const count = 1 << 16;
+			ring_type ring(&m_context, 1024);
+
+			std::thread producer_thread([&]()
+			{
+				ring_type::Producer producer(ring);
+				int block[100];
+				for(int i = 0; i < count; )
+				{
+					//Singles and blocks, in order
+					if(i % 1000 < 900)
+					{
+						producer.put(i++);
+					}
+					else
+					{
+						int n = std::min(100, count - i);
+						for(int j = 0; j < n; ++j)
+						{
+							block[j] = i + j;
+						}
+						producer.write(block, n);
+						i += n;
+					}
+				}
+				producer.close();
+			});
+
+			ring_type::Consumer consumer(ring);
+			int expected = 0;
+			bool ordered = true;
+			stream_range<int>(consumer) | sink([&](int x) {ordered = ordered && x == expected++;});
+			producer_thread.join();
+
+			GTL_TEST_VERIFY(tc, ordered);
+			GTL_TEST_EQ(tc, expected, count);
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+#ifndef _MSC_VER
+
+class Test_File_Stream : public Gtl_Test_Case
+{
+public:
+	virtual void run(Test_Context& tc)
+	{
+		char path[] = "/tmp/gtl_stream_XXXXXX";
+		int fd = mkstemp(path);
+		GTL_TEST_VERIFY(tc, fd >= 0);
+		if(fd < 0)
+		{
+			return;
+		}
+		close(fd);
+
+		{
+			gtl::Vector<char> text(&m_context);
+			for(int line = 0; line < 500; ++line)
+			{
+				char buffer[64];
+				int n = string::snprintf(buffer, 64, "line %d of the log\n", line);
+				text.insert(text.end(), buffer, buffer + n);
+			}
+
+			{
+				//Small buffer so puts and writes both spill over
+				File_Output_Stream out(&m_context, 64);
+				GTL_TEST_VERIFY(tc, out.open(path));
+				for(size_t i = 0; i < 100; ++i)
+				{
+					out.put(text[i]);
+				}
+				GTL_TEST_EQ(tc, out.write(text.begin() + 100, 10), 10u);
+
+				//Smaller than the buffer, each spills and starts the next
+				for(size_t i = 110; i < 910; i += 40)
+				{
+					GTL_TEST_EQ(tc, out.write(text.begin() + i, 40), 40u);
+				}
+				GTL_TEST_EQ(tc, out.write(text.begin() + 910, text.size() - 910), text.size() - 910);
+				GTL_TEST_VERIFY(tc, out.close());
+				GTL_TEST_VERIFY(tc, out.eof());
+			}
+
+			{
+				File_Input_Stream in(&m_context, 64);
+				GTL_TEST_VERIFY(tc, in.open(path));
+
+				gtl::Vector<char> read(&m_context);
+				for(size_t i = 0; i < 30; ++i)
+				{
+					read.push_back(in.get());
+				}
+
+				char buffer[1000];
+				while(size_t n = in.read(buffer, (read.size() % 3 + 1) * 50))
+				{
+					read.insert(read.end(), buffer, buffer + n);
+				}
+				GTL_TEST_VERIFY(tc, in.eof());
+				GTL_TEST_VERIFY(tc, !in.failed());
+				GTL_TEST_EQ(tc, read.size(), text.size());
+				GTL_TEST_VERIFY(tc, std::equal(read.begin(), read.end(), text.begin()));
+			}
+
+			{
+				Mapped_Input_Stream in;
+				GTL_TEST_VERIFY(tc, in.open(path));
+				GTL_TEST_EQ(tc, in.size(), text.size());
+
+				//Searched in place, then streamed from the match on
+				string::Char_Const_Range all = in.all();
+				size_t found = all.find("line 250");
+				GTL_TEST_VERIFY(tc, found < all.size());
+				in.seek(found);
+				GTL_TEST_EQ(tc, in.range().compare(all.slice(found, all.size())), 0);
+
+				gtl::Vector<char> rest(&m_context);
+				auto out_stream = container_out_stream<char>(rest);
+				stream_range<char>(in) | to_stream<char>(out_stream);
+				GTL_TEST_VERIFY(tc, in.eof());
+				GTL_TEST_EQ(tc, rest.size(), text.size() - found);
+				GTL_TEST_VERIFY(tc, std::equal(rest.begin(), rest.end(), text.begin() + found));
+			}
+
+			unlink(path);
+
+			{
+				File_Input_Stream in(&m_context);
+				Mapped_Input_Stream mapped;
+				GTL_TEST_VERIFY(tc, !in.open(path));
+				GTL_TEST_VERIFY(tc, in.eof());
+				GTL_TEST_VERIFY(tc, !mapped.open(path));
+				GTL_TEST_VERIFY(tc, mapped.eof());
+			}
+		}
+		GTL_TEST_EQ(tc, m_alloc.outstanding(), 0);
+	}
+};
+
+#endif
+
 void test_stream(Test_Platform& platform)
 {
 	Test_Suite suite("stream", platform);
 
 	Test_Stream test_stream;
 	suite.run("stream", test_stream);
+
+	Test_Stream_Block test_stream_block;
+	suite.run("stream block", test_stream_block);
+
+	Test_Pipeline test_pipeline;
+	suite.run("pipeline", test_pipeline);
+
+	Test_Readahead_Stream test_readahead_stream;
+	suite.run("readahead stream", test_readahead_stream);
+
+	Test_Spsc_Ring test_spsc_ring;
+	suite.run("spsc ring", test_spsc_ring);
+
+#ifndef _MSC_VER
+	Test_File_Stream test_file_stream;
+	suite.run("file stream", test_file_stream);
+#endif
 }
 
 } //ns
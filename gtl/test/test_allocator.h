@@ -24,6 +24,9 @@ namespace gtl {
 
 struct Test_Allocator : public gtl::Allocator
 {
+	using Allocator::allocate;
+	using Allocator::deallocate;
+
 	Test_Allocator() : m_alloc(0), m_dealloc(0) {}
 
 	~Test_Allocator()
@@ -22,6 +22,7 @@
 
 namespace gtl {
 
+	extern void test_allocator(Test_Platform& platform);
 	extern void test_containers(Test_Platform& platform);
 	extern void test_format(Test_Platform& platform);
 	extern void test_pool(Test_Platform& platform);
@@ -29,9 +30,11 @@ namespace gtl {
 	extern void test_scoped(Test_Platform& platform);
 	extern void test_range(Test_Platform& platform);
 	extern void test_stream(Test_Platform& platform);
+	extern void test_benchmark(Test_Platform& platform);
 
 	inline void run_tests(Test_Platform& platform)
 	{
+		test_allocator(platform);
 		test_containers(platform);
 		test_format(platform);
 		test_pool(platform);
@@ -40,6 +43,12 @@ namespace gtl {
 		test_range(platform);
 		test_stream(platform);
 	}
+
+	//Timings, opt in
+	inline void run_benchmarks(Test_Platform& platform)
+	{
+		test_benchmark(platform);
+	}
 }
 
 #endif
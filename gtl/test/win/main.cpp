@@ -51,6 +51,11 @@ int _tmain(int argc, _TCHAR* argv[])
 	using namespace gtl;
 	Win_Test_Platform platform;
 	run_tests(platform);
+
+	if(argc > 1 && _tcscmp(argv[1], _T("benchmark")) == 0)
+	{
+		run_benchmarks(platform);
+	}
 	return 0;
 }
 